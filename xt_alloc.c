@@ -0,0 +1,293 @@
+/**
+ *\file     xt_alloc.c
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    按大小分级的内存分配模块实现
+ */
+#include <stdlib.h>
+#include <pthread.h>
+#include "xt_alloc.h"
+#include "xt_memory_pool.h"
+#include "xt_utitly.h"
+
+#ifndef _WINDOWS
+    #include <sys/mman.h>
+#endif
+
+#ifdef XT_LOG
+    #include "xt_log.h"
+#else
+    #include <stdio.h>
+    #include <stdlib.h>
+    #ifdef _WINDOWS
+        #define D(...)      printf(__VA_ARGS__);printf("\n")
+        #define I(...)      printf(__VA_ARGS__);printf("\n")
+        #define W(...)      printf(__VA_ARGS__);printf("\n")
+        #define E(...)      printf(__VA_ARGS__);printf("\n")
+    #else
+        #define D(args...)  printf(args);printf("\n")
+        #define I(args...)  printf(args);printf("\n")
+        #define W(args...)  printf(args);printf("\n")
+        #define E(args...)  printf(args);printf("\n")
+    #endif
+#endif
+
+#define XT_ALLOC_HEAD       16          ///< 内存头大小,保证返回的内存按16字节对齐
+#define XT_ALLOC_SMALL      256         ///< 不超过此大小时每16字节一级,超过时每个2的幂区间分4级
+#define XT_ALLOC_CLASS      47          ///< 级别数量,32到256共15级,256到64KB共32级
+#define XT_ALLOC_SLAB       65536       ///< 每级内存池初始分配的内存大小
+#define XT_ALLOC_LARGE      0xFFFFFFFF  ///< 直接向系统映射的内存的级别
+#define XT_ALLOC_MAGIC      0x58544D41  ///< 内存头标记,用于检查错误的释放
+
+typedef struct _xt_alloc_head           ///  内存头
+{
+    size_t          size;               ///< 内存大小,含头
+    unsigned int    index;              ///< 级别,XT_ALLOC_LARGE为直接映射
+    unsigned int    magic;              ///< 标记
+
+} xt_alloc_head, *p_xt_alloc_head;
+
+xt_memory_pool      g_alloc_pool[XT_ALLOC_CLASS];                       ///< 各级内存池
+volatile long       g_alloc_ready[XT_ALLOC_CLASS] = { 0 };              ///< 各级内存池是否已初始化
+unsigned int        g_alloc_flags = 0;                                  ///< 各级内存池的选项
+pthread_mutex_t     g_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;          ///< 初始化内存池时的锁
+
+/**
+ *\brief                    得到大小所属的级别
+ *\param[in]    size        大小,含头,17到XT_ALLOC_MAX
+ *\return                   级别
+ */
+static int xt_alloc_index(size_t size)
+{
+    if (size <= XT_ALLOC_SMALL)
+    {
+        return (int)((size + 15) / 16) - 2;
+    }
+
+    size_t n = size - 1;
+    int    b = 8;
+
+    while (0 != (n >> (b + 1)))
+    {
+        b++;
+    }
+
+    return 15 + (b - 8) * 4 + (int)(n >> (b - 2)) - 4;
+}
+
+/**
+ *\brief                    得到级别的内存大小
+ *\param[in]    index       级别
+ *\return                   内存大小,含头
+ */
+static size_t xt_alloc_class_size(int index)
+{
+    if (index < 15)
+    {
+        return (size_t)(index + 2) * 16;
+    }
+
+    int b = 8 + (index - 15) / 4;
+    int k = (index - 15) % 4 + 1;
+
+    return ((size_t)1 << b) + ((size_t)k << (b - 2));
+}
+
+/**
+ *\brief                    得到级别的内存池,第一次使用时初始化
+ *\param[in]    index       级别
+ *\return                   内存池,失败时为NULL
+ */
+static p_xt_memory_pool xt_alloc_pool(int index)
+{
+    if (0 != ATOMIC_LOAD(&(g_alloc_ready[index])))
+    {
+        return &(g_alloc_pool[index]);
+    }
+
+    pthread_mutex_lock(&g_alloc_mutex);
+
+    if (0 == g_alloc_ready[index])
+    {
+        unsigned int size  = (unsigned int)xt_alloc_class_size(index);
+        unsigned int count = XT_ALLOC_SLAB / size;
+
+        if (0 != memory_pool_init_ex(&(g_alloc_pool[index]), size, (count < 2) ? 2 : count, g_alloc_flags | MEMORY_POOL_PACKED))
+        {
+            pthread_mutex_unlock(&g_alloc_mutex);
+            E("init pool fail, size:%u", size);
+            return NULL;
+        }
+
+        ATOMIC_STORE(&(g_alloc_ready[index]), 1);
+    }
+
+    pthread_mutex_unlock(&g_alloc_mutex);
+
+    return &(g_alloc_pool[index]);
+}
+
+/**
+ *\brief                    向系统映射内存
+ *\param[in]    size        大小
+ *\return                   内存,失败时为NULL
+ */
+static void* xt_alloc_map(size_t size)
+{
+#ifdef _WINDOWS
+    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (MAP_FAILED == mem) ? NULL : mem;
+#endif
+}
+
+/**
+ *\brief                    释放映射的内存
+ *\param[in]    mem         内存
+ *\param[in]    size        大小
+ *\return                   无
+ */
+static void xt_alloc_unmap(void *mem, size_t size)
+{
+#ifdef _WINDOWS
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, size);
+#endif
+}
+
+/**
+ *\brief                    初始化分配模块,不调用时使用默认选项
+ *\param[in]    flags       各级内存池的选项,MEMORY_POOL_MAGAZINE等的组合
+ *\return       0           成功
+ */
+int xt_alloc_init(unsigned int flags)
+{
+    pthread_mutex_lock(&g_alloc_mutex);
+
+    g_alloc_flags = flags;
+
+    pthread_mutex_unlock(&g_alloc_mutex);
+    return 0;
+}
+
+/**
+ *\brief                    反初始化分配模块,释放全部内存,调用后之前分配的内存都不能再使用
+ *\return       0           成功
+ */
+int xt_alloc_uninit()
+{
+    pthread_mutex_lock(&g_alloc_mutex);
+
+    for (int i = 0; i < XT_ALLOC_CLASS; i++)
+    {
+        if (0 != g_alloc_ready[i])
+        {
+            ATOMIC_STORE(&(g_alloc_ready[i]), 0);
+            memory_pool_uninit(&(g_alloc_pool[i]));
+        }
+    }
+
+    pthread_mutex_unlock(&g_alloc_mutex);
+    return 0;
+}
+
+/**
+ *\brief                    分配内存,按16字节对齐
+ *\param[in]    size        大小
+ *\return                   内存,失败时为NULL
+ */
+void* xt_alloc(size_t size)
+{
+    p_xt_alloc_head  head;
+    p_xt_memory_pool pool;
+
+    if (0 == size)
+    {
+        size = 1;
+    }
+
+    if (size <= XT_ALLOC_MAX - XT_ALLOC_HEAD)
+    {
+        int index = xt_alloc_index(size + XT_ALLOC_HEAD);
+
+        if (NULL == (pool = xt_alloc_pool(index)) || 0 != memory_pool_get(pool, (void**)&head))
+        {
+            return NULL;
+        }
+
+        head->size  = pool->mem_size;
+        head->index = (unsigned int)index;
+    }
+    else
+    {
+        if (size > (size_t)-1 - XT_ALLOC_MAX)
+        {
+            return NULL;
+        }
+
+        size = (size + XT_ALLOC_HEAD + XT_ALLOC_MAX - 1) & ~((size_t)XT_ALLOC_MAX - 1);  // 按64KB取整,与WINDOWS的分配粒度相同
+
+        if (NULL == (head = (p_xt_alloc_head)xt_alloc_map(size)))
+        {
+            E("map fail, size:%u", (unsigned int)size);
+            return NULL;
+        }
+
+        head->size  = size;
+        head->index = XT_ALLOC_LARGE;
+    }
+
+    head->magic = XT_ALLOC_MAGIC;
+    return (char*)head + XT_ALLOC_HEAD;
+}
+
+/**
+ *\brief                    释放由xt_alloc分配的内存
+ *\param[in]    mem         内存,可以为NULL
+ *\return                   无
+ */
+void xt_free(void *mem)
+{
+    if (NULL == mem)
+    {
+        return;
+    }
+
+    p_xt_alloc_head head = (p_xt_alloc_head)((char*)mem - XT_ALLOC_HEAD);
+
+    if (XT_ALLOC_MAGIC != head->magic)
+    {
+        E("free bad memory:%p", mem);
+        return;
+    }
+
+    head->magic = 0;
+
+    if (XT_ALLOC_LARGE == head->index)
+    {
+        xt_alloc_unmap(head, head->size);
+    }
+    else
+    {
+        memory_pool_put(&(g_alloc_pool[head->index]), head);
+    }
+}
+
+/**
+ *\brief                    得到内存的可用大小,不小于分配时的大小
+ *\param[in]    mem         由xt_alloc分配的内存
+ *\return                   可用大小
+ */
+size_t xt_alloc_size(void *mem)
+{
+    if (NULL == mem)
+    {
+        return 0;
+    }
+
+    return ((p_xt_alloc_head)((char*)mem - XT_ALLOC_HEAD))->size - XT_ALLOC_HEAD;
+}
@@ -0,0 +1,52 @@
+/**
+ *\file     xt_alloc.h
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    按大小分级的内存分配模块定义
+ *
+ * 不超过64KB的内存按大小分级,每级使用一个内存池,大于64KB的内存直接向系统映射\n
+ * 每块内存前有16字节的头,记录所属级别,xt_free时不需要传入大小
+ */
+#ifndef _XT_ALLOC_H_
+#define _XT_ALLOC_H_
+#include <stddef.h>
+
+#define XT_ALLOC_MAX        65536       ///< 内存池分配的最大内存,含头
+
+/**
+ *\brief                    初始化分配模块
+ *\param[in]    flags       各级内存池的选项,MEMORY_POOL_MAGAZINE等的组合
+ *\return       0           成功
+ */
+int xt_alloc_init(unsigned int flags);
+
+/**
+ *\brief                    反初始化分配模块,释放全部内存,调用后之前分配的内存都不能再使用
+ *\return       0           成功
+ */
+int xt_alloc_uninit();
+
+/**
+ *\brief                    分配内存,按16字节对齐
+ *\param[in]    size        大小
+ *\return                   内存,失败时为NULL
+ */
+void* xt_alloc(size_t size);
+
+/**
+ *\brief                    释放由xt_alloc分配的内存
+ *\param[in]    mem         内存,可以为NULL
+ *\return                   无
+ */
+void xt_free(void *mem);
+
+/**
+ *\brief                    得到内存的可用大小,不小于分配时的大小
+ *\param[in]    mem         由xt_alloc分配的内存
+ *\return                   可用大小
+ */
+size_t xt_alloc_size(void *mem);
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ *\file     xt_arena.c
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    区域分配模块实现
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "xt_arena.h"
+#include "xt_utitly.h"
+
+#ifdef XT_LOG
+    #include "xt_log.h"
+#else
+    #include <stdio.h>
+    #include <stdlib.h>
+    #ifdef _WINDOWS
+        #define D(...)      printf(__VA_ARGS__);printf("\n")
+        #define I(...)      printf(__VA_ARGS__);printf("\n")
+        #define W(...)      printf(__VA_ARGS__);printf("\n")
+        #define E(...)      printf(__VA_ARGS__);printf("\n")
+    #else
+        #define D(args...)  printf(args);printf("\n")
+        #define I(args...)  printf(args);printf("\n")
+        #define W(args...)  printf(args);printf("\n")
+        #define E(args...)  printf(args);printf("\n")
+    #endif
+#endif
+
+#define ARENA_ROUND(n)      (((n) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))  ///< 按ARENA_ALIGN取整
+#define ARENA_CHUNK_HEAD    ARENA_ROUND(sizeof(xt_arena_chunk))                     ///< 内存块头大小
+#define ARENA_LARGE_HEAD    ARENA_ROUND(sizeof(xt_arena_large))                     ///< 大内存头大小
+#define ARENA_CHUNK_MIN     256                                                     ///< 内存块最小大小
+
+/**
+ *\brief                    分配大内存
+ *\param[in]    arena       区域
+ *\param[in]    size        大小,已取整
+ *\return                   内存,失败时为NULL
+ */
+static void* arena_alloc_large(p_xt_arena arena, size_t size)
+{
+    p_xt_arena_large large;
+
+    if (NULL == ALIGNED_MALLOC(large, ARENA_ALIGN, ARENA_LARGE_HEAD + size))
+    {
+        E("malloc large fail, size:%u", (unsigned int)size);
+        return NULL;
+    }
+
+    large->next  = arena->large;
+    arena->large = large;
+    return (char*)large + ARENA_LARGE_HEAD;
+}
+
+/**
+ *\brief                    当前内存块不够时,使用下一个保留的内存块或从内存池得到新的内存块
+ *\param[in]    arena       区域
+ *\param[in]    size        大小,已取整
+ *\return                   内存,失败时为NULL
+ */
+static void* arena_alloc_chunk(p_xt_arena arena, size_t size)
+{
+    p_xt_arena_chunk next = (NULL == arena->chunk) ? arena->first : arena->chunk->next;
+
+    if (NULL == next)
+    {
+        if (0 != memory_pool_get(arena->pool, (void**)&next))
+        {
+            return NULL;
+        }
+
+        next->next = NULL;
+        next->end  = (char*)next + arena->pool->mem_size;
+
+        if (NULL == arena->chunk)
+        {
+            arena->first = next;
+        }
+        else
+        {
+            arena->chunk->next = next;
+        }
+    }
+
+    arena->chunk = next;
+    arena->pos   = (char*)next + ARENA_CHUNK_HEAD + size;
+    return (char*)next + ARENA_CHUNK_HEAD;
+}
+
+/**
+ *\brief                    初始化区域
+ *\param[in]    arena       区域
+ *\param[in]    pool        内存池,内存块大小不小于256
+ *\return       0           成功
+ */
+int arena_init(p_xt_arena arena, p_xt_memory_pool pool)
+{
+    if (NULL == arena || NULL == pool || pool->mem_size < ARENA_CHUNK_MIN)
+    {
+        return -1;
+    }
+
+    arena->pool  = pool;
+    arena->first = NULL;
+    arena->chunk = NULL;
+    arena->pos   = NULL;
+    arena->large = NULL;
+    return 0;
+}
+
+/**
+ *\brief                    反初始化区域,内存块放回内存池
+ *\param[in]    arena       区域
+ *\return       0           成功
+ */
+int arena_uninit(p_xt_arena arena)
+{
+    if (NULL == arena)
+    {
+        return -1;
+    }
+
+    p_xt_arena_chunk chunk;
+
+    arena_reset(arena);
+
+    while (NULL != arena->first)
+    {
+        chunk = arena->first;
+        arena->first = chunk->next;
+        memory_pool_put(arena->pool, chunk);
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                    分配内存,按ARENA_ALIGN对齐
+ *\param[in]    arena       区域
+ *\param[in]    size        大小
+ *\return                   内存,失败时为NULL
+ */
+void* arena_alloc(p_xt_arena arena, size_t size)
+{
+    if (NULL == arena || size > ((size_t)-1) / 2)
+    {
+        return NULL;
+    }
+
+    size = ARENA_ROUND((0 == size) ? 1 : size);
+
+    if (NULL != arena->chunk && size <= (size_t)(arena->chunk->end - arena->pos))
+    {
+        void *mem = arena->pos;
+        arena->pos += size;
+        return mem;
+    }
+
+    if (size > (arena->pool->mem_size - ARENA_CHUNK_HEAD) / 2)  // 超过内存块一半时单独分配,避免浪费内存块剩余的部分
+    {
+        return arena_alloc_large(arena, size);
+    }
+
+    return arena_alloc_chunk(arena, size);
+}
+
+/**
+ *\brief                    复制字符串
+ *\param[in]    arena       区域
+ *\param[in]    str         字符串
+ *\return                   复制的字符串,失败时为NULL
+ */
+char* arena_strdup(p_xt_arena arena, const char *str)
+{
+    if (NULL == str)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(str) + 1;
+    char  *dst = (char*)arena_alloc(arena, len);
+
+    if (NULL != dst)
+    {
+        memcpy(dst, str, len);
+    }
+
+    return dst;
+}
+
+/**
+ *\brief                    记录当前分配位置
+ *\param[in]    arena       区域
+ *\param[out]   mark        分配位置
+ *\return       0           成功
+ */
+int arena_mark(p_xt_arena arena, p_xt_arena_mark mark)
+{
+    if (NULL == arena || NULL == mark)
+    {
+        return -1;
+    }
+
+    mark->chunk = arena->chunk;
+    mark->pos   = arena->pos;
+    mark->large = arena->large;
+    return 0;
+}
+
+/**
+ *\brief                    回到记录的分配位置,之后分配的内存全部释放
+ *\param[in]    arena       区域
+ *\param[in]    mark        分配位置,记录后没有回到更早的位置
+ *\return       0           成功
+ */
+int arena_restore(p_xt_arena arena, p_xt_arena_mark mark)
+{
+    if (NULL == arena || NULL == mark)
+    {
+        return -1;
+    }
+
+    p_xt_arena_large large;
+
+    while (arena->large != mark->large && NULL != arena->large)
+    {
+        large = arena->large;
+        arena->large = large->next;
+        ALIGNED_FREE(large);
+    }
+
+    arena->chunk = mark->chunk;
+    arena->pos   = mark->pos;
+    return 0;
+}
+
+/**
+ *\brief                    释放全部分配的内存,内存块保留重复使用
+ *\param[in]    arena       区域
+ *\return       0           成功
+ */
+int arena_reset(p_xt_arena arena)
+{
+    xt_arena_mark mark = { NULL, NULL, NULL };
+
+    return arena_restore(arena, &mark);
+}
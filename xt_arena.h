@@ -0,0 +1,106 @@
+/**
+ *\file     xt_arena.h
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    区域分配模块定义
+ *
+ * 从内存池得到的内存块中顺序分配内存,分配只移动指针,不单独释放\n
+ * 用arena_mark记录位置,arena_restore回到该位置,可嵌套,arena_reset一次释放全部\n
+ * 回退时已得到的内存块留在区域中重复使用,arena_uninit时才放回内存池\n
+ * 区域不加锁,一个区域只在一个线程中使用,多个区域可共用一个内存池
+ */
+#ifndef _XT_ARENA_H_
+#define _XT_ARENA_H_
+#include <stddef.h>
+#include "xt_memory_pool.h"
+
+#define ARENA_ALIGN     16                      ///< 分配的内存按16字节对齐
+
+typedef struct _xt_arena_chunk                  ///  从内存池得到的内存块
+{
+    struct _xt_arena_chunk *next;               ///< 下一个内存块,后得到的在后面
+    char                   *end;                ///< 内存块结束位置
+
+} xt_arena_chunk, *p_xt_arena_chunk;
+
+typedef struct _xt_arena_large                  ///  大于内存块一半的内存,单独分配
+{
+    struct _xt_arena_large *next;               ///< 前一个大内存,后分配的在前面
+
+} xt_arena_large, *p_xt_arena_large;
+
+typedef struct _xt_arena_mark                   ///  分配位置
+{
+    p_xt_arena_chunk        chunk;              ///< 当前内存块
+    char                   *pos;                ///< 当前内存块中的分配位置
+    p_xt_arena_large        large;              ///< 最后分配的大内存
+
+} xt_arena_mark, *p_xt_arena_mark;
+
+typedef struct _xt_arena                        ///  区域
+{
+    p_xt_memory_pool        pool;               ///< 内存池
+    p_xt_arena_chunk        first;              ///< 第一个内存块
+    p_xt_arena_chunk        chunk;              ///< 当前内存块
+    char                   *pos;                ///< 当前内存块中的分配位置
+    p_xt_arena_large        large;              ///< 大内存链表
+
+} xt_arena, *p_xt_arena;
+
+/**
+ *\brief                    初始化区域
+ *\param[in]    arena       区域
+ *\param[in]    pool        内存池,内存块大小不小于256
+ *\return       0           成功
+ */
+int arena_init(p_xt_arena arena, p_xt_memory_pool pool);
+
+/**
+ *\brief                    反初始化区域,内存块放回内存池
+ *\param[in]    arena       区域
+ *\return       0           成功
+ */
+int arena_uninit(p_xt_arena arena);
+
+/**
+ *\brief                    分配内存,按ARENA_ALIGN对齐
+ *\param[in]    arena       区域
+ *\param[in]    size        大小
+ *\return                   内存,失败时为NULL
+ */
+void* arena_alloc(p_xt_arena arena, size_t size);
+
+/**
+ *\brief                    复制字符串
+ *\param[in]    arena       区域
+ *\param[in]    str         字符串
+ *\return                   复制的字符串,失败时为NULL
+ */
+char* arena_strdup(p_xt_arena arena, const char *str);
+
+/**
+ *\brief                    记录当前分配位置
+ *\param[in]    arena       区域
+ *\param[out]   mark        分配位置
+ *\return       0           成功
+ */
+int arena_mark(p_xt_arena arena, p_xt_arena_mark mark);
+
+/**
+ *\brief                    回到记录的分配位置,之后分配的内存全部释放
+ *\param[in]    arena       区域
+ *\param[in]    mark        分配位置,记录后没有回到更早的位置
+ *\return       0           成功
+ */
+int arena_restore(p_xt_arena arena, p_xt_arena_mark mark);
+
+/**
+ *\brief                    释放全部分配的内存,内存块保留重复使用
+ *\param[in]    arena       区域
+ *\return       0           成功
+ */
+int arena_reset(p_xt_arena arena);
+
+#endif
@@ -0,0 +1,749 @@
+/**
+ *\file     xt_bench.c
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    性能测试模块实现
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "xt_bench.h"
+#include "xt_list.h"
+#include "xt_memory_pool.h"
+#include "xt_thread_pool.h"
+#include "xt_utitly.h"
+
+#ifdef _WINDOWS
+    #include <windows.h>
+#else
+    #include <time.h>
+    #include <sched.h>
+#endif
+
+#ifdef XT_LOG
+    #include "xt_log.h"
+#else
+    #include <stdio.h>
+    #include <stdlib.h>
+    #ifdef _WINDOWS
+        #define D(...)      printf(__VA_ARGS__);printf("\n")
+        #define I(...)      printf(__VA_ARGS__);printf("\n")
+        #define W(...)      printf(__VA_ARGS__);printf("\n")
+        #define E(...)      printf(__VA_ARGS__);printf("\n")
+    #else
+        #define D(args...)  printf(args);printf("\n")
+        #define I(args...)  printf(args);printf("\n")
+        #define W(args...)  printf(args);printf("\n")
+        #define E(args...)  printf(args);printf("\n")
+    #endif
+#endif
+
+#define BENCH_OPS           1000000     ///< 每项测试默认总操作数
+#define BENCH_SAMPLE_MAX    65536       ///< 每个线程最多记录的延迟样本数
+#define BENCH_THREAD_MAX    64          ///< 最大线程数量
+#define BENCH_MEM_SIZE      1024        ///< 内存池测试的内存块大小
+#define BENCH_SPIN          64          ///< 入队出队失败时自旋次数,超过后让出CPU
+#define BENCH_POOL_SPIN     2000        ///< 线程池测试中工作线程等待前的自旋次数
+#define BENCH_POOL_PACE     100         ///< 线程池测试逐个添加任务,任务数量为总操作数的几分之一
+
+typedef unsigned long long  bench_ns;   ///< 纳秒
+
+typedef struct _xt_bench_ctx            ///  测试上下文
+{
+    pthread_mutex_t     mutex;          ///< 线程锁
+    pthread_cond_t      cond;           ///< 开始或结束条件
+    unsigned int        ready;          ///< 已就绪的线程数量
+    bool                go;             ///< 是否开始
+
+    p_xt_list           list;           ///< 测试的链表
+    p_xt_memory_pool    pool;           ///< 测试的内存池
+
+    volatile long       done;           ///< 已开始执行的任务数量
+    unsigned int        ops;            ///< 任务数量
+
+} xt_bench_ctx, *p_xt_bench_ctx;
+
+typedef struct _xt_bench_thread         ///  测试线程
+{
+    p_xt_bench_ctx      ctx;            ///< 测试上下文
+    pthread_t           tid;            ///< 线程ID
+
+    unsigned int        ops;            ///< 本线程操作数
+    unsigned int        step;           ///< 每几个操作记录一个延迟样本
+    unsigned int        sample_max;     ///< 最多记录的样本数
+    unsigned int        sample_count;   ///< 已记录的样本数
+    bench_ns           *sample;         ///< 延迟样本
+
+    bench_ns            begin;          ///< 开始时间
+    bench_ns            end;            ///< 结束时间
+
+} xt_bench_thread, *p_xt_bench_thread;
+
+typedef struct _xt_bench_task           ///  线程池测试任务
+{
+    p_xt_bench_ctx      ctx;            ///< 测试上下文
+    bench_ns            submit;         ///< 添加任务时间
+    bench_ns            latency;        ///< 添加到开始执行的时间
+
+} xt_bench_task, *p_xt_bench_task;
+
+/**
+ *\brief                    得到单调时间
+ *\return                   纳秒
+ */
+static bench_ns bench_now()
+{
+#ifdef _WINDOWS
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER now;
+
+    if (0 == freq.QuadPart)
+    {
+        QueryPerformanceFrequency(&freq);
+    }
+
+    QueryPerformanceCounter(&now);
+    return (bench_ns)((double)now.QuadPart * 1000000000.0 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (bench_ns)ts.tv_sec * 1000000000ULL + (bench_ns)ts.tv_nsec;
+#endif
+}
+
+/**
+ *\brief                    让出CPU
+ *\param[in]    spin        已自旋次数
+ *\return                   无
+ */
+static void bench_pause(unsigned int spin)
+{
+    if (spin < BENCH_SPIN)
+    {
+        CPU_RELAX();
+        return;
+    }
+
+#ifdef _WINDOWS
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+/**
+ *\brief                    比较延迟,用于排序
+ *\param[in]    a           延迟a
+ *\param[in]    b           延迟b
+ *\return                   比较结果
+ */
+static int bench_compare(const void *a, const void *b)
+{
+    bench_ns x = *(const bench_ns*)a;
+    bench_ns y = *(const bench_ns*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ *\brief                    计算排序后样本的分位值
+ *\param[in]    sample      排序后的样本
+ *\param[in]    count       样本数量
+ *\param[in]    ratio       分位,如0.99
+ *\return                   分位值
+ */
+static double bench_percentile(bench_ns *sample, unsigned int count, double ratio)
+{
+    unsigned int i = (unsigned int)(ratio * count);
+
+    if (0 == count)
+    {
+        return 0.0;
+    }
+
+    return (double)sample[(i < count) ? i : count - 1];
+}
+
+/**
+ *\brief                    按延迟样本填写测试结果
+ *\param[out]   result      测试结果
+ *\param[in]    sample      样本,会被排序
+ *\param[in]    count       样本数量
+ *\param[in]    ops         总操作数
+ *\param[in]    time        总时间,纳秒
+ *\return                   无
+ */
+static void bench_result_fill(p_xt_bench_result result, bench_ns *sample, unsigned int count, unsigned int ops, bench_ns time)
+{
+    qsort(sample, count, sizeof(bench_ns), bench_compare);
+
+    result->ops         = ops;
+    result->ops_per_sec = (time > 0) ? ops * 1000000000.0 / (double)time : 0.0;
+    result->p50_ns      = bench_percentile(sample, count, 0.50);
+    result->p99_ns      = bench_percentile(sample, count, 0.99);
+    result->p999_ns     = bench_percentile(sample, count, 0.999);
+    result->max_ns      = (count > 0) ? (double)sample[count - 1] : 0.0;
+}
+
+/**
+ *\brief                    初始化测试结果的名称和参数
+ *\param[out]   result      测试结果
+ *\param[in]    name        测试对象
+ *\param[in]    op          测试操作
+ *\param[in]    threads     线程数量
+ *\param[in]    depth       队列深度
+ *\return                   无
+ */
+static void bench_result_init(p_xt_bench_result result, const char *name, const char *op, unsigned int threads, unsigned int depth)
+{
+    memset(result, 0, sizeof(xt_bench_result));
+    strncpy(result->name, name, sizeof(result->name) - 1);
+    strncpy(result->op, op, sizeof(result->op) - 1);
+    result->threads = threads;
+    result->depth   = depth;
+}
+
+/**
+ *\brief                    记录延迟样本
+ *\param[in]    thread      测试线程
+ *\param[in]    i           操作序号
+ *\param[in]    ns          延迟
+ *\return                   无
+ */
+static void bench_sample(p_xt_bench_thread thread, unsigned int i, bench_ns ns)
+{
+    if (0 == i % thread->step && thread->sample_count < thread->sample_max)
+    {
+        thread->sample[thread->sample_count++] = ns;
+    }
+}
+
+/**
+ *\brief                    测试线程就绪后等待全部线程一起开始
+ *\param[in]    thread      测试线程
+ *\return                   无
+ */
+static void bench_wait_go(p_xt_bench_thread thread)
+{
+    p_xt_bench_ctx ctx = thread->ctx;
+
+    pthread_mutex_lock(&(ctx->mutex));
+
+    ctx->ready++;
+    pthread_cond_broadcast(&(ctx->cond));
+
+    while (!ctx->go)
+    {
+        pthread_cond_wait(&(ctx->cond), &(ctx->mutex));
+    }
+
+    pthread_mutex_unlock(&(ctx->mutex));
+
+    thread->begin = bench_now();
+}
+
+/**
+ *\brief                    链表测试线程,交替入队出队
+ *\param[in]    thread      测试线程
+ *\return                   空
+ */
+static void* bench_list_thread(p_xt_bench_thread thread)
+{
+    void        *data = thread;
+    bench_ns     t0;
+    unsigned int spin;
+    p_xt_list    list = thread->ctx->list;
+
+    bench_wait_go(thread);
+
+    for (unsigned int i = 0; i < thread->ops; i++)
+    {
+        t0 = bench_now();
+
+        for (spin = 0; 0 != list_tail_push(list, data); spin++)
+        {
+            bench_pause(spin);
+        }
+
+        for (spin = 0; 0 != list_head_pop(list, &data); spin++)
+        {
+            bench_pause(spin);
+        }
+
+        bench_sample(thread, i, bench_now() - t0);
+    }
+
+    thread->end = bench_now();
+    return NULL;
+}
+
+/**
+ *\brief                    内存池测试线程,交替得到回收
+ *\param[in]    thread      测试线程
+ *\return                   空
+ */
+static void* bench_memory_pool_thread(p_xt_bench_thread thread)
+{
+    void            *mem;
+    bench_ns         t0;
+    p_xt_memory_pool pool = thread->ctx->pool;
+
+    bench_wait_go(thread);
+
+    for (unsigned int i = 0; i < thread->ops; i++)
+    {
+        t0 = bench_now();
+
+        memory_pool_get(pool, &mem);
+        memory_pool_put(pool, mem);
+
+        bench_sample(thread, i, bench_now() - t0);
+    }
+
+    thread->end = bench_now();
+    return NULL;
+}
+
+/**
+ *\brief                    启动多个测试线程,全部就绪后同时开始,结束后汇总结果
+ *\param[in]    ctx         测试上下文
+ *\param[in]    threads     线程数量
+ *\param[in]    ops         总操作数
+ *\param[in]    proc        线程函数
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+static int bench_threads_run(p_xt_bench_ctx ctx, unsigned int threads, unsigned int ops, void* (*proc)(p_xt_bench_thread), p_xt_bench_result result)
+{
+    int               ret    = 0;
+    unsigned int      count  = 0;
+    unsigned int      per    = ops / threads;
+    bench_ns          begin  = 0;
+    bench_ns          end    = 0;
+    bench_ns         *sample = malloc(sizeof(bench_ns) * BENCH_SAMPLE_MAX * threads);
+    p_xt_bench_thread thread = calloc(threads, sizeof(xt_bench_thread));
+
+    if (NULL == sample || NULL == thread)
+    {
+        free(sample);
+        free(thread);
+        return -2;
+    }
+
+    pthread_mutex_init(&(ctx->mutex), NULL);
+    pthread_cond_init(&(ctx->cond), NULL);
+    ctx->ready = 0;
+    ctx->go    = false;
+
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        thread[i].ctx        = ctx;
+        thread[i].ops        = per;
+        thread[i].step       = per / BENCH_SAMPLE_MAX + 1;
+        thread[i].sample_max = BENCH_SAMPLE_MAX;
+        thread[i].sample     = &(sample[i * BENCH_SAMPLE_MAX]);
+
+        if (0 != pthread_create(&(thread[i].tid), NULL, proc, &(thread[i])))
+        {
+            E("create thread fail");
+            threads = i;
+            ret = -3;
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&(ctx->mutex));
+
+    while (ctx->ready < threads)
+    {
+        pthread_cond_wait(&(ctx->cond), &(ctx->mutex));
+    }
+
+    ctx->go = true;
+    pthread_cond_broadcast(&(ctx->cond));
+
+    pthread_mutex_unlock(&(ctx->mutex));
+
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        pthread_join(thread[i].tid, NULL);
+
+        begin = (0 == i || thread[i].begin < begin) ? thread[i].begin : begin;
+        end   = (thread[i].end > end) ? thread[i].end : end;
+
+        memmove(&(sample[count]), thread[i].sample, sizeof(bench_ns) * thread[i].sample_count);
+        count += thread[i].sample_count;
+    }
+
+    bench_result_fill(result, sample, count, per * threads, end - begin);
+
+    pthread_cond_destroy(&(ctx->cond));
+    pthread_mutex_destroy(&(ctx->mutex));
+    free(thread);
+    free(sample);
+    return ret;
+}
+
+/**
+ *\brief                    测试链表入队出队,每个线程交替入队出队
+ *\param[in]    type        链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC
+ *\param[in]    threads     线程数量
+ *\param[in]    depth       测试前预先放入的数据数量
+ *\param[in]    ops         总操作数,一次入队加一次出队为一个操作
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_list(int type, unsigned int threads, unsigned int depth, unsigned int ops, p_xt_bench_result result)
+{
+    if ((LIST_TYPE_MUTEX != type && LIST_TYPE_MPMC != type) || 0 == threads || threads > ops || NULL == result)
+    {
+        return -1;
+    }
+
+    xt_list      list;
+    xt_bench_ctx ctx;
+
+    bench_result_init(result, (LIST_TYPE_MPMC == type) ? "list_mpmc" : "list_mutex", "push_pop", threads, depth);
+
+    if (0 != list_init_ex(&list, type, depth + threads + 1))    // 无锁链表容量要能放下预先放入的数据和每个线程的一个数据
+    {
+        return -2;
+    }
+
+    for (unsigned int i = 0; i < depth; i++)
+    {
+        list_tail_push(&list, &ctx);
+    }
+
+    ctx.list = &list;
+
+    int ret = bench_threads_run(&ctx, threads, ops, bench_list_thread, result);
+
+    list_uninit(&list);
+    return ret;
+}
+
+/**
+ *\brief                    测试链表增长时的入队延迟,从空链表连续入队
+ *\param[in]    type        链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC
+ *\param[in]    ops         入队数量
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_list_grow(int type, unsigned int ops, p_xt_bench_result result)
+{
+    if ((LIST_TYPE_MUTEX != type && LIST_TYPE_MPMC != type) || 0 == ops || NULL == result)
+    {
+        return -1;
+    }
+
+    xt_list   list;
+    void     *data;
+    bench_ns  t0;
+    bench_ns  begin;
+    bench_ns *sample = malloc(sizeof(bench_ns) * ops);
+
+    bench_result_init(result, (LIST_TYPE_MPMC == type) ? "list_mpmc" : "list_mutex", "push_grow", 1, 0);
+
+    if (NULL == sample)
+    {
+        return -2;
+    }
+
+    if (0 != list_init_ex(&list, type, (LIST_TYPE_MPMC == type) ? ops : 0))  // 无锁链表容量固定,按总数分配
+    {
+        free(sample);
+        return -3;
+    }
+
+    begin = bench_now();
+
+    for (unsigned int i = 0; i < ops; i++)
+    {
+        t0 = bench_now();
+        list_tail_push(&list, sample);
+        sample[i] = bench_now() - t0;
+    }
+
+    bench_result_fill(result, sample, ops, ops, bench_now() - begin);
+
+    while (0 == list_head_pop(&list, &data));
+
+    list_uninit(&list);
+    free(sample);
+    return 0;
+}
+
+/**
+ *\brief                    测试内存池得到回收内存,每个线程交替得到回收
+ *\param[in]    threads     线程数量
+ *\param[in]    count       内存池初始内存块数量
+ *\param[in]    ops         总操作数,一次得到加一次回收为一个操作
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_memory_pool(unsigned int threads, unsigned int count, unsigned int ops, p_xt_bench_result result)
+{
+    if (0 == threads || threads > ops || count < 2 || NULL == result)
+    {
+        return -1;
+    }
+
+    xt_memory_pool pool;
+    xt_bench_ctx   ctx;
+
+    bench_result_init(result, "memory_pool", "get_put", threads, count);
+
+    if (0 != memory_pool_init(&pool, BENCH_MEM_SIZE, count))
+    {
+        return -2;
+    }
+
+    ctx.pool = &pool;
+
+    int ret = bench_threads_run(&ctx, threads, ops, bench_memory_pool_thread, result);
+
+    memory_pool_uninit(&pool);
+    return ret;
+}
+
+/**
+ *\brief                    线程池测试任务,记录从添加到开始执行的时间
+ *\param[in]    param       测试任务
+ *\return                   无
+ */
+static void bench_thread_pool_task(void *param)
+{
+    p_xt_bench_task task = (p_xt_bench_task)param;
+    p_xt_bench_ctx  ctx  = task->ctx;
+
+    task->latency = bench_now() - task->submit;
+
+    if ((long)ctx->ops == ATOMIC_ADD(&(ctx->done), 1))  // 最后一个任务
+    {
+        pthread_mutex_lock(&(ctx->mutex));
+        ctx->go = true;
+        pthread_cond_signal(&(ctx->cond));
+        pthread_mutex_unlock(&(ctx->mutex));
+    }
+}
+
+/**
+ *\brief                    测试线程池从添加任务到任务开始执行的延迟\n
+ *                          上一个任务执行后才添加下一个任务,工作线程每次都已空闲,测的是唤醒延迟
+ *\param[in]    threads     线程池线程数量
+ *\param[in]    spin        工作线程等待前自旋次数,0为不自旋
+ *\param[in]    ops         任务数量
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_thread_pool(unsigned int threads, unsigned int spin, unsigned int ops, p_xt_bench_result result)
+{
+    if (0 == threads || 0 == ops || NULL == result)
+    {
+        return -1;
+    }
+
+    bench_ns         begin;
+    bench_ns         end;
+    xt_bench_ctx     ctx;
+    xt_thread_pool_attr attr;
+    bench_ns        *sample = malloc(sizeof(bench_ns) * ops);
+    p_xt_bench_task  task   = malloc(sizeof(xt_bench_task) * ops);
+    p_xt_thread_pool pool   = malloc(sizeof(xt_thread_pool));
+
+    bench_result_init(result, (0 == spin) ? "thread_pool" : "thread_pool_spin", "submit_start", threads, 0);
+
+    thread_pool_attr_init(&attr);
+    attr.thread_count = threads;
+    attr.spin_count   = spin;
+
+    if (NULL == sample || NULL == task || NULL == pool || 0 != thread_pool_init_ex(pool, &attr))
+    {
+        free(sample);
+        free(task);
+        free(pool);
+        return -2;
+    }
+
+    pthread_mutex_init(&(ctx.mutex), NULL);
+    pthread_cond_init(&(ctx.cond), NULL);
+    ctx.go   = false;
+    ctx.done = 0;
+    ctx.ops  = ops;
+
+    begin = bench_now();
+
+    for (unsigned int i = 0; i < ops; i++)
+    {
+        task[i].ctx    = &ctx;
+        task[i].submit = bench_now();
+        thread_pool_put(pool, bench_thread_pool_task, &(task[i]));
+
+        for (unsigned int n = 0; (long)(i + 1) != ATOMIC_LOAD(&(ctx.done)); n++)
+        {
+            bench_pause(n);
+        }
+    }
+
+    pthread_mutex_lock(&(ctx.mutex));
+
+    while (!ctx.go)
+    {
+        pthread_cond_wait(&(ctx.cond), &(ctx.mutex));
+    }
+
+    pthread_mutex_unlock(&(ctx.mutex));
+
+    end = bench_now();
+
+    thread_pool_uninit(pool);
+
+    for (unsigned int n = 0; NULL != ATOMIC_LOAD(&(pool->worker)); n++)    // 线程分离运行,最后退出的线程释放完线程池数据后才能释放
+    {
+        bench_pause(n);
+    }
+
+    free(pool);
+
+    for (unsigned int i = 0; i < ops; i++)
+    {
+        sample[i] = task[i].latency;
+    }
+
+    bench_result_fill(result, sample, ops, ops, end - begin);
+
+    pthread_cond_destroy(&(ctx.cond));
+    pthread_mutex_destroy(&(ctx.mutex));
+    free(sample);
+    free(task);
+    return 0;
+}
+
+/**
+ *\brief                    输出测试结果
+ *\param[in]    file        输出文件
+ *\param[in]    format      输出格式:BENCH_FORMAT_CSV,BENCH_FORMAT_JSON
+ *\param[in]    result      测试结果数组
+ *\param[in]    count       测试结果数量
+ *\return       0           成功
+ */
+int bench_write(FILE *file, int format, p_xt_bench_result result, unsigned int count)
+{
+    if (NULL == file || (BENCH_FORMAT_CSV != format && BENCH_FORMAT_JSON != format) || (NULL == result && count > 0))
+    {
+        return -1;
+    }
+
+    if (BENCH_FORMAT_CSV == format)
+    {
+        fprintf(file, "name,op,threads,depth,ops,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns\n");
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            fprintf(file, "%s,%s,%u,%u,%u,%.0f,%.0f,%.0f,%.0f,%.0f\n",
+                    result[i].name, result[i].op, result[i].threads, result[i].depth, result[i].ops,
+                    result[i].ops_per_sec, result[i].p50_ns, result[i].p99_ns, result[i].p999_ns, result[i].max_ns);
+        }
+    }
+    else
+    {
+        fprintf(file, "[\n");
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            fprintf(file, "  {\"name\":\"%s\",\"op\":\"%s\",\"threads\":%u,\"depth\":%u,\"ops\":%u,"
+                          "\"ops_per_sec\":%.0f,\"p50_ns\":%.0f,\"p99_ns\":%.0f,\"p999_ns\":%.0f,\"max_ns\":%.0f}%s\n",
+                    result[i].name, result[i].op, result[i].threads, result[i].depth, result[i].ops,
+                    result[i].ops_per_sec, result[i].p50_ns, result[i].p99_ns, result[i].p999_ns, result[i].max_ns,
+                    (i + 1 < count) ? "," : "");
+        }
+
+        fprintf(file, "]\n");
+    }
+
+    fflush(file);
+    return 0;
+}
+
+/**
+ *\brief                    保留成功的测试结果,失败的不输出
+ *\param[in]    ret         测试的返回值
+ *\param[in]    result      测试结果
+ *\param[in,out] count      测试结果数量,成功时加1
+ *\return                   无
+ */
+static void bench_keep(int ret, p_xt_bench_result result, unsigned int *count)
+{
+    if (0 != ret)
+    {
+        W("bench fail, name:%s op:%s threads:%u ret:%d", result->name, result->op, result->threads, ret);
+        return;
+    }
+
+    (*count)++;
+}
+
+/**
+ *\brief                    按1-64线程,不同队列深度运行全部测试并输出结果
+ *\param[in]    file        输出文件
+ *\param[in]    format      输出格式:BENCH_FORMAT_CSV,BENCH_FORMAT_JSON
+ *\param[in]    ops         每项测试的总操作数,0为默认值
+ *\return       0           成功
+ */
+int bench_run(FILE *file, int format, unsigned int ops)
+{
+    if (NULL == file || (BENCH_FORMAT_CSV != format && BENCH_FORMAT_JSON != format))
+    {
+        return -1;
+    }
+
+    if (0 == ops)
+    {
+        ops = BENCH_OPS;
+    }
+
+    int          type[]  = { LIST_TYPE_MUTEX, LIST_TYPE_MPMC };
+    unsigned int depth[] = { 0, 1024 };
+    unsigned int count   = 0;
+    unsigned int max     = 128;
+    unsigned int paced   = (ops / BENCH_POOL_PACE < 1000) ? 1000 : ops / BENCH_POOL_PACE;
+    p_xt_bench_result result = malloc(sizeof(xt_bench_result) * max);
+
+    if (NULL == result)
+    {
+        return -2;
+    }
+
+    for (unsigned int t = 0; t < SIZEOF(type); t++)
+    {
+        bench_keep(bench_list_grow(type[t], ops, &(result[count])), &(result[count]), &count);
+
+        for (unsigned int d = 0; d < SIZEOF(depth); d++)
+        {
+            for (unsigned int threads = 1; threads <= BENCH_THREAD_MAX; threads *= 2)
+            {
+                bench_keep(bench_list(type[t], threads, depth[d], ops, &(result[count])), &(result[count]), &count);
+            }
+        }
+    }
+
+    for (unsigned int threads = 1; threads <= BENCH_THREAD_MAX; threads *= 2)
+    {
+        bench_keep(bench_memory_pool(threads, 1024, ops, &(result[count])), &(result[count]), &count);
+    }
+
+    for (unsigned int threads = 1; threads <= BENCH_THREAD_MAX; threads *= 2)
+    {
+        bench_keep(bench_thread_pool(threads, 0, paced, &(result[count])), &(result[count]), &count);
+        bench_keep(bench_thread_pool(threads, BENCH_POOL_SPIN, paced, &(result[count])), &(result[count]), &count);
+    }
+
+    D("bench count:%u", count);
+
+    int ret = bench_write(file, format, result, count);
+
+    free(result);
+    return ret;
+}
@@ -0,0 +1,97 @@
+/**
+ *\file     xt_bench.h
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    性能测试模块定义,测试链表,内存池,线程池的吞吐量和延迟
+ */
+#ifndef _XT_BENCH_H_
+#define _XT_BENCH_H_
+#include <stdio.h>  // FILE
+
+/// 输出格式
+enum
+{
+    BENCH_FORMAT_CSV,                       ///< CSV
+    BENCH_FORMAT_JSON                       ///< JSON
+};
+
+typedef struct _xt_bench_result             ///  测试结果
+{
+    char            name[64];               ///< 测试对象,如list_mutex,list_mpmc,memory_pool,thread_pool
+    char            op[32];                 ///< 测试操作,如push_pop,push_grow,get_put,submit_start
+
+    unsigned int    threads;                ///< 线程数量
+    unsigned int    depth;                  ///< 队列深度或内存池初始数量
+    unsigned int    ops;                    ///< 总操作数
+
+    double          ops_per_sec;            ///< 每秒操作数
+    double          p50_ns;                 ///< 延迟50%分位,纳秒
+    double          p99_ns;                 ///< 延迟99%分位,纳秒
+    double          p999_ns;                ///< 延迟99.9%分位,纳秒
+    double          max_ns;                 ///< 最大延迟,纳秒
+
+} xt_bench_result, *p_xt_bench_result;      ///< 测试结果指针
+
+/**
+ *\brief                    测试链表入队出队,每个线程交替入队出队
+ *\param[in]    type        链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC
+ *\param[in]    threads     线程数量
+ *\param[in]    depth       测试前预先放入的数据数量
+ *\param[in]    ops         总操作数,一次入队加一次出队为一个操作
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_list(int type, unsigned int threads, unsigned int depth, unsigned int ops, p_xt_bench_result result);
+
+/**
+ *\brief                    测试链表增长时的入队延迟,从空链表连续入队
+ *\param[in]    type        链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC
+ *\param[in]    ops         入队数量
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_list_grow(int type, unsigned int ops, p_xt_bench_result result);
+
+/**
+ *\brief                    测试内存池得到回收内存,每个线程交替得到回收
+ *\param[in]    threads     线程数量
+ *\param[in]    count       内存池初始内存块数量
+ *\param[in]    ops         总操作数,一次得到加一次回收为一个操作
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_memory_pool(unsigned int threads, unsigned int count, unsigned int ops, p_xt_bench_result result);
+
+/**
+ *\brief                    测试线程池从添加任务到任务开始执行的延迟\n
+ *                          上一个任务执行后才添加下一个任务,工作线程每次都已空闲,测的是唤醒延迟
+ *\param[in]    threads     线程池线程数量
+ *\param[in]    spin        工作线程等待前自旋次数,0为不自旋
+ *\param[in]    ops         任务数量
+ *\param[out]   result      测试结果
+ *\return       0           成功
+ */
+int bench_thread_pool(unsigned int threads, unsigned int spin, unsigned int ops, p_xt_bench_result result);
+
+/**
+ *\brief                    输出测试结果
+ *\param[in]    file        输出文件
+ *\param[in]    format      输出格式:BENCH_FORMAT_CSV,BENCH_FORMAT_JSON
+ *\param[in]    result      测试结果数组
+ *\param[in]    count       测试结果数量
+ *\return       0           成功
+ */
+int bench_write(FILE *file, int format, p_xt_bench_result result, unsigned int count);
+
+/**
+ *\brief                    按1-64线程,不同队列深度运行全部测试并输出结果
+ *\param[in]    file        输出文件
+ *\param[in]    format      输出格式:BENCH_FORMAT_CSV,BENCH_FORMAT_JSON
+ *\param[in]    ops         每项测试的总操作数,0为默认值
+ *\return       0           成功
+ */
+int bench_run(FILE *file, int format, unsigned int ops);
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ *\file     xt_dlist.c
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    侵入式双向链表实现
+ */
+#include "xt_dlist.h"
+
+/**
+ *\brief                    把节点链接到prev和next之间
+ *\param[in]    prev        前一个节点
+ *\param[in]    next        后一个节点
+ *\param[in]    node        节点
+ *\return                   无
+ */
+static void dlist_link(p_xt_dlist_node prev, p_xt_dlist_node next, p_xt_dlist_node node)
+{
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+/**
+ *\brief                    初始化链表或节点,节点初始化后指向自己,表示不在链表中
+ *\param[in]    list        链表或节点
+ *\return       0           成功
+ */
+int dlist_init(p_xt_dlist list)
+{
+    if (NULL == list)
+    {
+        return -1;
+    }
+
+    list->prev = list;
+    list->next = list;
+    return 0;
+}
+
+/**
+ *\brief                    链表是否为空
+ *\param[in]    list        链表
+ *\return       1           空\n
+                0           非空
+ */
+int dlist_empty(p_xt_dlist list)
+{
+    return (NULL == list || list->next == list) ? 1 : 0;
+}
+
+/**
+ *\brief                    节点是否在链表中
+ *\param[in]    node        节点
+ *\return       1           在链表中\n
+                0           不在链表中
+ */
+int dlist_linked(p_xt_dlist_node node)
+{
+    return (NULL != node && node->next != node) ? 1 : 0;
+}
+
+/**
+ *\brief                    在链表头部添加节点
+ *\param[in]    list        链表
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_push_head(p_xt_dlist list, p_xt_dlist_node node)
+{
+    if (NULL == list || NULL == node)
+    {
+        return -1;
+    }
+
+    dlist_link(list, list->next, node);
+    return 0;
+}
+
+/**
+ *\brief                    在链表尾部添加节点
+ *\param[in]    list        链表
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_push_tail(p_xt_dlist list, p_xt_dlist_node node)
+{
+    if (NULL == list || NULL == node)
+    {
+        return -1;
+    }
+
+    dlist_link(list->prev, list, node);
+    return 0;
+}
+
+/**
+ *\brief                    在指定节点后面插入节点
+ *\param[in]    pos         链表中的节点
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_insert_after(p_xt_dlist_node pos, p_xt_dlist_node node)
+{
+    if (NULL == pos || NULL == node)
+    {
+        return -1;
+    }
+
+    dlist_link(pos, pos->next, node);
+    return 0;
+}
+
+/**
+ *\brief                    在指定节点前面插入节点
+ *\param[in]    pos         链表中的节点
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_insert_before(p_xt_dlist_node pos, p_xt_dlist_node node)
+{
+    if (NULL == pos || NULL == node)
+    {
+        return -1;
+    }
+
+    dlist_link(pos->prev, pos, node);
+    return 0;
+}
+
+/**
+ *\brief                    从所在链表中删除节点,删除后节点指向自己,可重复删除
+ *\param[in]    node        节点
+ *\return       0           成功
+ */
+int dlist_unlink(p_xt_dlist_node node)
+{
+    if (NULL == node)
+    {
+        return -1;
+    }
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+    return 0;
+}
+
+/**
+ *\brief                    把节点移到链表尾部,用于LRU
+ *\param[in]    list        链表
+ *\param[in]    node        节点,在任意链表中或已用dlist_init初始化
+ *\return       0           成功
+ */
+int dlist_move_tail(p_xt_dlist list, p_xt_dlist_node node)
+{
+    if (NULL == list || NULL == node)
+    {
+        return -1;
+    }
+
+    dlist_unlink(node);
+    dlist_link(list->prev, list, node);
+    return 0;
+}
+
+/**
+ *\brief                    得到链表头节点
+ *\param[in]    list        链表
+ *\return                   头节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_head(p_xt_dlist list)
+{
+    return dlist_empty(list) ? NULL : list->next;
+}
+
+/**
+ *\brief                    得到链表尾节点
+ *\param[in]    list        链表
+ *\return                   尾节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_tail(p_xt_dlist list)
+{
+    return dlist_empty(list) ? NULL : list->prev;
+}
+
+/**
+ *\brief                    删除并得到链表头节点
+ *\param[in]    list        链表
+ *\return                   头节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_pop_head(p_xt_dlist list)
+{
+    p_xt_dlist_node node = dlist_head(list);
+
+    if (NULL != node)
+    {
+        dlist_unlink(node);
+    }
+
+    return node;
+}
+
+/**
+ *\brief                    把src链表的全部节点移到dst链表尾部,src变为空链表
+ *\param[in]    dst         目的链表
+ *\param[in]    src         源链表
+ *\return       0           成功
+ */
+int dlist_splice_tail(p_xt_dlist dst, p_xt_dlist src)
+{
+    if (NULL == dst || NULL == src)
+    {
+        return -1;
+    }
+
+    if (dlist_empty(src))
+    {
+        return 0;
+    }
+
+    p_xt_dlist_node first = src->next;
+    p_xt_dlist_node last  = src->prev;
+
+    first->prev     = dst->prev;
+    dst->prev->next = first;
+    last->next      = dst;
+    dst->prev       = last;
+
+    src->next = src;
+    src->prev = src;
+    return 0;
+}
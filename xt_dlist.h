@@ -0,0 +1,152 @@
+/**
+ *\file     xt_dlist.h
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    侵入式双向链表定义
+ *
+ * 链表节点嵌入在数据结构中,插入删除不分配内存,可在O(1)时间删除任意节点\n
+ * 链表不加锁,多线程使用时由调用者加锁
+ */
+#ifndef _XT_DLIST_H_
+#define _XT_DLIST_H_
+#include <stddef.h>
+
+typedef struct _xt_dlist_node               ///  链表节点,嵌入在数据结构中
+{
+    struct _xt_dlist_node  *prev;           ///< 前一个节点
+
+    struct _xt_dlist_node  *next;           ///< 后一个节点
+
+} xt_dlist_node, *p_xt_dlist_node;          ///< 链表节点指针
+
+typedef xt_dlist_node   xt_dlist;           ///< 链表头,是一个不存数据的哨兵节点
+typedef p_xt_dlist_node p_xt_dlist;         ///< 链表头指针
+
+/**
+ *\brief                    由节点得到包含节点的数据结构
+ *\param[in]    node        节点
+ *\param[in]    type        数据结构类型
+ *\param[in]    member      节点在数据结构中的成员名
+ */
+#define DLIST_ENTRY(node, type, member)     ((type*)((char*)(node) - offsetof(type, member)))
+
+/**
+ *\brief                    从头到尾遍历链表
+ *\param[out]   node        当前节点
+ *\param[in]    list        链表
+ *\attention                遍历时不能删除当前节点,删除时使用DLIST_FOREACH_SAFE
+ */
+#define DLIST_FOREACH(node, list) \
+    for ((node) = (list)->next; (node) != (list); (node) = (node)->next)
+
+/**
+ *\brief                    从头到尾遍历链表,遍历时可以删除当前节点
+ *\param[out]   node        当前节点
+ *\param[out]   tmp         下一个节点
+ *\param[in]    list        链表
+ */
+#define DLIST_FOREACH_SAFE(node, tmp, list) \
+    for ((node) = (list)->next, (tmp) = (node)->next; (node) != (list); (node) = (tmp), (tmp) = (node)->next)
+
+/**
+ *\brief                    初始化链表或节点,节点初始化后指向自己,表示不在链表中
+ *\param[in]    list        链表或节点
+ *\return       0           成功
+ */
+int dlist_init(p_xt_dlist list);
+
+/**
+ *\brief                    链表是否为空
+ *\param[in]    list        链表
+ *\return       1           空\n
+                0           非空
+ */
+int dlist_empty(p_xt_dlist list);
+
+/**
+ *\brief                    节点是否在链表中
+ *\param[in]    node        节点
+ *\return       1           在链表中\n
+                0           不在链表中
+ */
+int dlist_linked(p_xt_dlist_node node);
+
+/**
+ *\brief                    在链表头部添加节点
+ *\param[in]    list        链表
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_push_head(p_xt_dlist list, p_xt_dlist_node node);
+
+/**
+ *\brief                    在链表尾部添加节点
+ *\param[in]    list        链表
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_push_tail(p_xt_dlist list, p_xt_dlist_node node);
+
+/**
+ *\brief                    在指定节点后面插入节点
+ *\param[in]    pos         链表中的节点
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_insert_after(p_xt_dlist_node pos, p_xt_dlist_node node);
+
+/**
+ *\brief                    在指定节点前面插入节点
+ *\param[in]    pos         链表中的节点
+ *\param[in]    node        节点,不能在其它链表中
+ *\return       0           成功
+ */
+int dlist_insert_before(p_xt_dlist_node pos, p_xt_dlist_node node);
+
+/**
+ *\brief                    从所在链表中删除节点,删除后节点指向自己,可重复删除
+ *\param[in]    node        节点
+ *\return       0           成功
+ */
+int dlist_unlink(p_xt_dlist_node node);
+
+/**
+ *\brief                    把节点移到链表尾部,用于LRU
+ *\param[in]    list        链表
+ *\param[in]    node        节点,在任意链表中或已用dlist_init初始化
+ *\return       0           成功
+ */
+int dlist_move_tail(p_xt_dlist list, p_xt_dlist_node node);
+
+/**
+ *\brief                    得到链表头节点
+ *\param[in]    list        链表
+ *\return                   头节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_head(p_xt_dlist list);
+
+/**
+ *\brief                    得到链表尾节点
+ *\param[in]    list        链表
+ *\return                   尾节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_tail(p_xt_dlist list);
+
+/**
+ *\brief                    删除并得到链表头节点
+ *\param[in]    list        链表
+ *\return                   头节点,链表为空时为NULL
+ */
+p_xt_dlist_node dlist_pop_head(p_xt_dlist list);
+
+/**
+ *\brief                    把src链表的全部节点移到dst链表尾部,src变为空链表
+ *\param[in]    dst         目的链表
+ *\param[in]    src         源链表
+ *\return       0           成功
+ */
+int dlist_splice_tail(p_xt_dlist dst, p_xt_dlist src);
+
+#endif
@@ -7,8 +7,16 @@
  *\brief    链表数据结构实现
  */
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include "xt_list.h"
 
+#ifndef _WINDOWS
+    #include <unistd.h>
+    #include <sys/time.h>
+    #include <sys/eventfd.h>
+#endif
+
 #ifdef XT_LOG
     #include "xt_log.h"
 #else
@@ -29,196 +37,1330 @@
 
 #define SV          sizeof(void*)   ///< void指针大小
 
-#define NODE_SIZE   1024            ///< 节点初始大小
+#define NODE_SIZE   1024            ///< 节点初始大小,LIST_TYPE_MUTEX为空闲块缓存保留的节点数
+
+#define LIST_BATCH_SIZE 64          ///< list_drain每次取出的数量
+
+#ifdef _WINDOWS
+    #define LIST_NOTIFY_NULL    NULL    ///< 无通知句柄
+#else
+    #define LIST_NOTIFY_NULL    -1      ///< 无通知句柄
+#endif
 
 /**
- *\brief                链表初始化
+ *\brief                设置通知句柄为可读
  *\param[in]    list    链表
- *\return       0       成功
+ *\return               无
  */
-int list_init(p_xt_list list)
+static void list_notify_set(p_xt_list list)
 {
-    if (NULL == list)
+#ifdef _WINDOWS
+    SetEvent(list->notify);
+#else
+    unsigned long long one = 1;
+    write(list->notify, &one, sizeof(one));
+#endif
+}
+
+/**
+ *\brief                数据入队后唤醒等待的线程,调用者加锁
+ *\param[in]    list    链表
+ *\param[in]    empty   入队前链表是否为空
+ *\param[in]    count   入队数量
+ *\return               无
+ */
+static void list_mutex_signal(p_xt_list list, bool empty, int count)
+{
+    if (empty && LIST_NOTIFY_NULL != list->notify)
     {
-        return -1;
+        list_notify_set(list);
     }
 
-    pthread_mutex_init(&(list->mutex), NULL);
-    pthread_mutex_lock(&(list->mutex));
-
-    list->count = 0;
-    list->head = -1;    // 无数据
-    list->tail = -1;    // 无数据
-    list->size = NODE_SIZE;
-    list->data = malloc(SV * list->size);
-
-    pthread_mutex_unlock(&(list->mutex));
-    return 0;
+    if (list->waiter > 0)
+    {
+        if (count > 1)
+        {
+            pthread_cond_broadcast(&(list->cond));
+        }
+        else
+        {
+            pthread_cond_signal(&(list->cond));
+        }
+    }
 }
 
 /**
- *\brief                链表反初始化
+ *\brief                无锁链表数据入队后唤醒等待的线程
  *\param[in]    list    链表
- *\return       0       成功
+ *\param[in]    pos     入队的第一个位置
+ *\param[in]    count   入队数量
+ *\return               无
  */
-int list_uninit(p_xt_list list)
+static void list_mpmc_signal(p_xt_list list, unsigned long pos, int count)
 {
-    if (NULL == list)
+    ATOMIC_FENCE();     // 先写节点再读等待状态,与list_head_pop_wait中的先加等待数再读节点配对
+
+    if (LIST_NOTIFY_NULL != list->notify && ATOMIC_LOAD(&(list->pop_pos)) == pos)  // 入队前链表为空
     {
-        return -1;
+        list_notify_set(list);
     }
 
-    list->count = 0;
-    list->head = -1;    // 无数据
-    list->tail = -1;    // 无数据
-    list->size = 0;
-    free(list->data);
-
-    pthread_mutex_destroy(&(list->mutex));
-    return 0;
+    if (ATOMIC_LOAD(&(list->waiter)) > 0)
+    {
+        pthread_mutex_lock(&(list->mutex));
+        list_mutex_signal(list, false, count);
+        pthread_mutex_unlock(&(list->mutex));
+    }
 }
 
 /**
- *\brief                在链表尾部添加数据
+ *\brief                得到空闲块,优先使用缓存的块,调用者加锁
  *\param[in]    list    链表
- *\param[in]    data    数据
- *\return       0       成功
+ *\return               块,分配内存失败时为NULL
  */
-int list_tail_push(p_xt_list list, void *data)
+static p_xt_list_block list_block_get(p_xt_list list)
 {
-    if (NULL == list)
+    p_xt_list_block block = list->free_block;
+
+    if (NULL != block)
     {
-        return -1;
+        list->free_block = block->next;
+        list->free_count--;
     }
-
-    pthread_mutex_lock(&(list->mutex));
-
-    if (0 == list->count)
+    else if (NULL == (block = malloc(sizeof(xt_list_block))))
     {
-        list->head = 0;
-        list->tail = 0;
-        list->data[0] = data;
+        E("malloc block fail");
+        return NULL;
     }
-    else if (list->count < list->size)
+
+    block->next = NULL;
+    return block;
+}
+
+/**
+ *\brief                回收块,缓存已满时释放内存,调用者加锁
+ *\param[in]    list    链表
+ *\param[in]    block   块
+ *\return               无
+ */
+static void list_block_put(p_xt_list list, p_xt_list_block block)
+{
+    if (list->free_count < list->free_max)
     {
-        list->tail = (list->tail + 1) % list->size;
-        list->data[list->tail] = data;
+        block->next = list->free_block;
+        list->free_block = block;
+        list->free_count++;
     }
     else
     {
-        int    old_size = list->size;
-        void **old_data = list->data;
+        free(block);    // 突发数据取完后归还内存
+    }
+}
 
-        list->size = old_size + old_size / 2;   // 数据扩大一半
-        list->data = malloc(SV * list->size);
+/**
+ *\brief                在尾部添加多个数据,尾块满时链接新块,调用者加锁
+ *\param[in]    list    链表
+ *\param[in]    data    数据数组
+ *\param[in]    count   数据数量
+ *\return               添加的数量,得到新块失败时小于count,已添加的数据不变
+ */
+static int list_mutex_push_n(p_xt_list list, void **data, int count)
+{
+    int n;
+    int total = 0;
 
-        if (list->head <= list->tail)           // 头节点在尾节点前面
+    while (count > 0)
+    {
+        if (LIST_BLOCK_SIZE == list->tail)
         {
-            D("add array old size:%d head:%d <= tail:%d", old_size, list->head, list->tail);
-            memcpy(list->data, old_data, SV * old_size);
-            D("add array new size:%d head:%d tail:%d", list->size, list->head, list->tail);
+            p_xt_list_block block = list_block_get(list);
+
+            if (NULL == block)
+            {
+                break;
+            }
+
+            list->tail_block->next = block;
+            list->tail_block = block;
+            list->tail = 0;
         }
-        else
+
+        n = LIST_BLOCK_SIZE - list->tail;
+
+        if (n > count)
         {
-            D("add array old size:%d head:%d > tail:%d", old_size, list->head, list->tail);
+            n = count;
+        }
+
+        memcpy(&(list->tail_block->data[list->tail]), data, SV * n);
 
-            int cnt = old_size + list->head;
-            int head = list->size - cnt;
-            memcpy(list->data, old_data, SV * (list->tail + 1));
-            memcpy(&list->data[list->size - cnt], &old_data[list->head], SV * cnt);
-            list->head = head;
+        list->tail  += n;
+        list->count += n;
+        data        += n;
+        count       -= n;
+        total       += n;
+    }
+
+    return total;
+}
+
+/**
+ *\brief                从头部得到多个数据,头块取完时回收,调用者加锁
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   数组大小
+ *\return               得到的数量
+ */
+static int list_mutex_pop_n(p_xt_list list, void **data, int count)
+{
+    int n;
+    int total = 0;
 
-            D("add array new size:%d head:%d tail:%d", list->size, list->head, list->tail);
+    while (count > 0 && list->count > 0)
+    {
+        n = ((list->head_block == list->tail_block) ? list->tail : LIST_BLOCK_SIZE) - list->head;
+
+        if (n > count)
+        {
+            n = count;
         }
 
-        free(old_data);
+        memcpy(data, &(list->head_block->data[list->head]), SV * n);
+
+        list->head  += n;
+        list->count -= n;
+        data        += n;
+        count       -= n;
+        total       += n;
 
-        list->tail++;
-        list->data[list->tail] = data;
+        if (0 == list->count)   // 只剩一个块,从块开头重新使用
+        {
+            list->head = 0;
+            list->tail = 0;
+        }
+        else if (LIST_BLOCK_SIZE == list->head)
+        {
+            p_xt_list_block block = list->head_block;
+            list->head_block = block->next;
+            list->head = 0;
+            list_block_put(list, block);
+        }
     }
 
-    list->count++;
+    return total;
+}
+
+/**
+ *\brief                从头部得到数据,调用者加锁
+ *\param[in]    list    链表
+ *\param[out]   data    数据
+ *\return       0       成功\n
+                -2      无数据
+ */
+static int list_mutex_pop(p_xt_list list, void **data)
+{
+    return (1 == list_mutex_pop_n(list, data, 1)) ? 0 : -2;
+}
 
-    D("size:%d count:%d head:%d tail:%d", list->size, list->count, list->head, list->tail);
+/**
+ *\brief                无锁链表尾部添加数据
+ *\param[in]    list    链表
+ *\param[in]    data    数据
+ *\return       0       成功\n
+                -2      链表已满
+ */
+static int list_mpmc_push(p_xt_list list, void *data)
+{
+    long            dif;
+    p_xt_list_cell  cell;
+    unsigned long   pos = ATOMIC_LOAD(&(list->push_pos));
 
-    pthread_mutex_unlock(&(list->mutex));
+    for (;;)
+    {
+        cell = &(list->cell[pos & list->mask]);
+        dif  = (long)(ATOMIC_LOAD(&(cell->seq)) - pos);
+
+        if (0 == dif)       // 节点可写,抢占写入位置
+        {
+            if (ATOMIC_CAS(&(list->push_pos), pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)   // 节点数据还没有被读走,链表已满
+        {
+            return -2;
+        }
+
+        pos = ATOMIC_LOAD(&(list->push_pos));
+    }
 
+    cell->data = data;
+    ATOMIC_STORE(&(cell->seq), pos + 1);    // 节点可读
+
+    list_mpmc_signal(list, pos, 1);
     return 0;
 }
 
 /**
- *\brief                从链表头部得到数据
+ *\brief                无锁链表头部得到数据
  *\param[in]    list    链表
  *\param[out]   data    数据
- *\return       0       成功
+ *\return       0       成功\n
+                -2      无数据
  */
-int list_head_pop(p_xt_list list, void **data)
+static int list_mpmc_pop(p_xt_list list, void **data)
 {
-    if (NULL == list || NULL == data)
+    long            dif;
+    p_xt_list_cell  cell;
+    unsigned long   pos = ATOMIC_LOAD(&(list->pop_pos));
+
+    for (;;)
     {
-        return -1;
+        cell = &(list->cell[pos & list->mask]);
+        dif  = (long)(ATOMIC_LOAD(&(cell->seq)) - (pos + 1));
+
+        if (0 == dif)       // 节点可读,抢占读取位置
+        {
+            if (ATOMIC_CAS(&(list->pop_pos), pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)   // 节点还没有写入数据,链表为空
+        {
+            return -2;
+        }
+
+        pos = ATOMIC_LOAD(&(list->pop_pos));
     }
 
-    if (1 == list->count)
+    *data = cell->data;
+    ATOMIC_STORE(&(cell->seq), pos + list->mask + 1);  // 节点在下一圈可写
+    return 0;
+}
+
+/**
+ *\brief                无锁链表尾部添加多个数据,一次抢占连续的多个节点
+ *\param[in]    list    链表
+ *\param[in]    data    数据数组
+ *\param[in]    count   输入数据数量,输出添加的数量
+ *\return       0       成功\n
+                -2      链表已满
+ */
+static int list_mpmc_push_n(p_xt_list list, void **data, int *count)
+{
+    int             n;
+    long            dif;
+    unsigned long   pos = ATOMIC_LOAD(&(list->push_pos));
+
+    for (;;)
     {
-        pthread_mutex_lock(&(list->mutex));
+        for (n = 0; n < *count; n++)    // 从写入位置开始连续可写的节点数量
+        {
+            if (ATOMIC_LOAD(&(list->cell[(pos + n) & list->mask].seq)) != pos + n)
+            {
+                break;
+            }
+        }
 
-        *data = list->data[list->head];
+        if (n > 0)
+        {
+            if (ATOMIC_CAS(&(list->push_pos), pos, pos + n))
+            {
+                break;
+            }
+        }
+        else
+        {
+            dif = (long)(ATOMIC_LOAD(&(list->cell[pos & list->mask].seq)) - pos);
 
-        list->head = -1;
-        list->tail = -1;
-        list->count = 0;
+            if (dif < 0)
+            {
+                return -2;
+            }
+        }
 
-        pthread_mutex_unlock(&(list->mutex));
+        pos = ATOMIC_LOAD(&(list->push_pos));
+    }
 
-        return 0;
+    for (int i = 0; i < n; i++)
+    {
+        list->cell[(pos + i) & list->mask].data = data[i];
+        ATOMIC_STORE(&(list->cell[(pos + i) & list->mask].seq), pos + i + 1);
     }
 
-    if (list->count > 1)
+    list_mpmc_signal(list, pos, n);
+
+    *count = n;
+    return 0;
+}
+
+/**
+ *\brief                无锁链表头部得到多个数据,一次抢占连续的多个节点
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   输入数组大小,输出得到的数量
+ *\return       0       成功\n
+                -2      无数据
+ */
+static int list_mpmc_pop_n(p_xt_list list, void **data, int *count)
+{
+    int             n;
+    long            dif;
+    unsigned long   pos = ATOMIC_LOAD(&(list->pop_pos));
+
+    for (;;)
     {
-        pthread_mutex_lock(&(list->mutex));
+        for (n = 0; n < *count; n++)    // 从读取位置开始连续可读的节点数量
+        {
+            if (ATOMIC_LOAD(&(list->cell[(pos + n) & list->mask].seq)) != pos + n + 1)
+            {
+                break;
+            }
+        }
 
-        *data = list->data[list->head];
-        list->head = (list->head + 1) % list->size;
-        list->count--;
+        if (n > 0)
+        {
+            if (ATOMIC_CAS(&(list->pop_pos), pos, pos + n))
+            {
+                break;
+            }
+        }
+        else
+        {
+            dif = (long)(ATOMIC_LOAD(&(list->cell[pos & list->mask].seq)) - (pos + 1));
 
-        pthread_mutex_unlock(&(list->mutex));
+            if (dif < 0)
+            {
+                return -2;
+            }
+        }
 
-        return 0;
+        pos = ATOMIC_LOAD(&(list->pop_pos));
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = list->cell[(pos + i) & list->mask].data;
+        ATOMIC_STORE(&(list->cell[(pos + i) & list->mask].seq), pos + i + list->mask + 1);
     }
 
-    return -2;
+    *count = n;
+    return 0;
 }
 
 /**
- *\brief                调用指定的回调函数遍历链表
+ *\brief                遍历无锁链表,遍历时不能有其它线程出队
  *\param[in]    list    链表
  *\param[in]    proc    回调函数
  *\param[in]    param   自定义数据
  *\return       0       成功\n
-                1       无节点\n
-                其它    失败
+                1       无节点
  */
-int list_proc(p_xt_list list, LIST_PROC proc, void *param)
+static int list_mpmc_proc(p_xt_list list, LIST_PROC proc, void *param)
 {
-    if (NULL == list || NULL == proc)
+    p_xt_list_cell  cell;
+    unsigned long   pos = ATOMIC_LOAD(&(list->pop_pos));
+    unsigned long   end = ATOMIC_LOAD(&(list->push_pos));
+
+    if (pos == end)
     {
-        return -1;
+        return 1;
     }
 
-    if (list->count <= 0)
+    for (; pos != end; pos++)
     {
-        return 1;
+        cell = &(list->cell[pos & list->mask]);
+
+        if (ATOMIC_LOAD(&(cell->seq)) != pos + 1)   // 节点正在被写入
+        {
+            break;
+        }
+
+        if (0 != proc(cell->data, param))
+        {
+            break;
+        }
     }
 
-    pthread_mutex_lock(&(list->mutex));
+    return 0;
+}
 
-    for (int i = 0; i < list->count; i++)
+/**
+ *\brief                复制无锁链表的全部数据,读数据前后节点序号不变才有效
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   数组大小
+ *\return               复制的数量
+ */
+static int list_mpmc_copy(p_xt_list list, void **data, int count)
+{
+    int             n   = 0;
+    p_xt_list_cell  cell;
+    unsigned long   pos = ATOMIC_LOAD(&(list->pop_pos));
+
+    for (; n < count; pos++)
     {
-        proc(list->data[(list->head + i) % list->size], param);
+        cell = &(list->cell[pos & list->mask]);
+
+        if (ATOMIC_LOAD(&(cell->seq)) != pos + 1)   // 无数据或正在被写入
+        {
+            break;
+        }
+
+        data[n] = cell->data;
+
+        ATOMIC_FENCE();
+
+        if (ATOMIC_LOAD(&(cell->seq)) != pos + 1)   // 读取时节点被取走,数据无效
+        {
+            break;
+        }
+
+        n++;
     }
 
-    pthread_mutex_unlock(&(list->mutex));
+    return n;
+}
+
+/**
+ *\brief                单生产者单消费者链表尾部添加多个数据,只能在生产者线程调用
+ *\param[in]    list    链表
+ *\param[in]    data    数据数组
+ *\param[in]    count   输入数据数量,输出添加的数量
+ *\return       0       成功\n
+                -2      链表已满
+ */
+static int list_spsc_push_n(p_xt_list list, void **data, int *count)
+{
+    unsigned long pos  = list->push_pos;                    // 只有生产者修改写入位置
+    unsigned long room = list->size - (pos - list->push_cache);
+
+    if (room < (unsigned long)*count)   // 缓存的读取位置显示空间不足时才读消费者的缓存行
+    {
+        list->push_cache = ATOMIC_LOAD(&(list->pop_pos));
+        room = list->size - (pos - list->push_cache);
+
+        if (0 == room)
+        {
+            return -2;
+        }
+    }
+
+    int n = (room < (unsigned long)*count) ? (int)room : *count;
+
+    for (int i = 0; i < n; i++)
+    {
+        list->data[(pos + i) & list->mask] = data[i];
+    }
+
+    ATOMIC_STORE(&(list->push_pos), pos + n);
+
+    list_mpmc_signal(list, pos, n);
+
+    *count = n;
+    return 0;
+}
+
+/**
+ *\brief                单生产者单消费者链表头部得到多个数据,只能在消费者线程调用
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   输入数组大小,输出得到的数量
+ *\return       0       成功\n
+                -2      无数据
+ */
+static int list_spsc_pop_n(p_xt_list list, void **data, int *count)
+{
+    unsigned long pos   = list->pop_pos;                    // 只有消费者修改读取位置
+    unsigned long avail = list->pop_cache - pos;
+
+    if (avail < (unsigned long)*count)  // 缓存的写入位置显示数据不足时才读生产者的缓存行
+    {
+        list->pop_cache = ATOMIC_LOAD(&(list->push_pos));
+        avail = list->pop_cache - pos;
+
+        if (0 == avail)
+        {
+            return -2;
+        }
+    }
+
+    int n = (avail < (unsigned long)*count) ? (int)avail : *count;
+
+    for (int i = 0; i < n; i++)
+    {
+        data[i] = list->data[(pos + i) & list->mask];
+    }
+
+    ATOMIC_STORE(&(list->pop_pos), pos + n);
+
+    *count = n;
+    return 0;
+}
 
+/**
+ *\brief                复制单生产者单消费者链表的全部数据,读数据后节点没有被取走才有效
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   数组大小
+ *\return               复制的数量
+ */
+static int list_spsc_copy(p_xt_list list, void **data, int count)
+{
+    int           n   = 0;
+    unsigned long pos = ATOMIC_LOAD(&(list->pop_pos));
+    unsigned long end = ATOMIC_LOAD(&(list->push_pos));
+
+    for (; n < count && pos != end; pos++)
+    {
+        data[n] = list->data[pos & list->mask];
+
+        ATOMIC_FENCE();
+
+        if ((long)(ATOMIC_LOAD(&(list->pop_pos)) - pos) > 0)   // 节点已被取走,可能已被新数据覆盖
+        {
+            break;
+        }
+
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ *\brief                遍历单生产者单消费者链表,只能在消费者线程调用或没有出队时调用
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数
+ *\param[in]    param   自定义数据
+ *\return       0       成功\n
+                1       无节点
+ */
+static int list_spsc_proc(p_xt_list list, LIST_PROC proc, void *param)
+{
+    unsigned long pos = ATOMIC_LOAD(&(list->pop_pos));
+    unsigned long end = ATOMIC_LOAD(&(list->push_pos));
+
+    if (pos == end)
+    {
+        return 1;
+    }
+
+    for (; pos != end; pos++)
+    {
+        if (0 != proc(list->data[pos & list->mask], param))
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                无锁链表尾部添加数据
+ *\param[in]    list    链表
+ *\param[in]    data    数据
+ *\return       0       成功\n
+                -2      链表已满
+ */
+static int list_lockfree_push(p_xt_list list, void *data)
+{
+    int count = 1;
+    return (LIST_TYPE_SPSC == list->type) ? list_spsc_push_n(list, &data, &count) : list_mpmc_push(list, data);
+}
+
+/**
+ *\brief                无锁链表头部得到数据
+ *\param[in]    list    链表
+ *\param[out]   data    数据
+ *\return       0       成功\n
+                -2      无数据
+ */
+static int list_lockfree_pop(p_xt_list list, void **data)
+{
+    int count = 1;
+    return (LIST_TYPE_SPSC == list->type) ? list_spsc_pop_n(list, data, &count) : list_mpmc_pop(list, data);
+}
+
+/**
+ *\brief                链表初始化,类型为LIST_TYPE_MUTEX
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_init(p_xt_list list)
+{
+    return list_init_ex(list, LIST_TYPE_MUTEX, NODE_SIZE);
+}
+
+/**
+ *\brief                链表初始化
+ *\param[in]    list    链表
+ *\param[in]    type    链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC,LIST_TYPE_SPSC
+ *\param[in]    size    LIST_TYPE_MUTEX为空闲块缓存保留的节点数,无锁链表为容量,向上取2的幂,0为默认值
+ *\return       0       成功\n
+                -3      分配内存失败
+ */
+int list_init_ex(p_xt_list list, int type, unsigned int size)
+{
+    if (NULL == list || (LIST_TYPE_MUTEX != type && LIST_TYPE_MPMC != type && LIST_TYPE_SPSC != type))
+    {
+        return -1;
+    }
+
+    if (size < 2)
+    {
+        size = NODE_SIZE;
+    }
+
+    list->type   = type;
+    list->cell   = NULL;
+    list->data   = NULL;
+    list->waiter = 0;
+    list->wakeup = 0;
+    list->notify = LIST_NOTIFY_NULL;
+
+    pthread_mutex_init(&(list->mutex), NULL);
+    pthread_cond_init(&(list->cond), NULL);
+    pthread_mutex_lock(&(list->mutex));
+
+    list->count      = 0;
+    list->head_block = NULL;
+    list->tail_block = NULL;
+    list->free_block = NULL;
+    list->free_count = 0;
+
+    if (LIST_TYPE_MUTEX == type)
+    {
+        list->free_max   = (size + LIST_BLOCK_SIZE - 1) / LIST_BLOCK_SIZE;  // 缓存初始大小的块
+        list->size       = list->free_max * LIST_BLOCK_SIZE;
+        list->head_block = list_block_get(list);
+        list->tail_block = list->head_block;
+        list->head       = 0;
+        list->tail       = 0;
+    }
+    else
+    {
+        unsigned long cap = 2;
+
+        while (cap < size)
+        {
+            cap <<= 1;
+        }
+
+        list->size       = (int)cap;
+        list->mask       = cap - 1;
+        list->push_pos   = 0;
+        list->push_cache = 0;
+        list->pop_pos    = 0;
+        list->pop_cache  = 0;
+
+        if (LIST_TYPE_SPSC == type)
+        {
+            list->data = malloc(SV * cap);
+        }
+        else if (NULL != (list->cell = malloc(sizeof(xt_list_cell) * cap)))
+        {
+            for (unsigned long i = 0; i < cap; i++)
+            {
+                list->cell[i].seq  = i; // 序号等于写入位置时可写
+                list->cell[i].data = NULL;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    if (NULL == list->head_block && NULL == list->data && NULL == list->cell)
+    {
+        E("malloc list fail, type:%d size:%u", type, size);
+        pthread_cond_destroy(&(list->cond));
+        pthread_mutex_destroy(&(list->mutex));
+        return -3;
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                链表反初始化
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_uninit(p_xt_list list)
+{
+    if (NULL == list)
+    {
+        return -1;
+    }
+
+    p_xt_list_block block;
+
+    while (NULL != list->head_block)
+    {
+        block = list->head_block;
+        list->head_block = block->next;
+        free(block);
+    }
+
+    while (NULL != list->free_block)
+    {
+        block = list->free_block;
+        list->free_block = block->next;
+        free(block);
+    }
+
+    list->tail_block = NULL;
+    list->free_count = 0;
+    list->count = 0;
+    list->size = 0;
+    free(list->cell);
+    free(list->data);
+    list->cell = NULL;
+    list->data = NULL;
+
+    if (LIST_NOTIFY_NULL != list->notify)
+    {
+#ifdef _WINDOWS
+        CloseHandle(list->notify);
+#else
+        close(list->notify);
+#endif
+        list->notify = LIST_NOTIFY_NULL;
+    }
+
+    pthread_cond_destroy(&(list->cond));
+    pthread_mutex_destroy(&(list->mutex));
+    return 0;
+}
+
+/**
+ *\brief                在链表尾部添加数据
+ *\param[in]    list    链表
+ *\param[in]    data    数据
+ *\return       0       成功\n
+                -2      无锁链表已满\n
+                -3      分配块失败,链表不变
+ */
+int list_tail_push(p_xt_list list, void *data)
+{
+    if (NULL == list)
+    {
+        return -1;
+    }
+
+    if (LIST_TYPE_MUTEX != list->type)
+    {
+        return list_lockfree_push(list, data);
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    if (0 == list_mutex_push_n(list, &data, 1))
+    {
+        pthread_mutex_unlock(&(list->mutex));
+        return -3;
+    }
+
+    list_mutex_signal(list, 1 == list->count, 1);
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    return 0;
+}
+
+/**
+ *\brief                从链表头部得到数据
+ *\param[in]    list    链表
+ *\param[out]   data    数据
+ *\return       0       成功
+ */
+int list_head_pop(p_xt_list list, void **data)
+{
+    if (NULL == list || NULL == data)
+    {
+        return -1;
+    }
+
+    if (LIST_TYPE_MUTEX != list->type)
+    {
+        return list_lockfree_pop(list, data);
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    int ret = list_mutex_pop(list, data);
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    return ret;
+}
+
+/**
+ *\brief                调用指定的回调函数遍历链表
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数,返回非0时退出遍历
+ *\param[in]    param   自定义数据
+ *\return       0       成功\n
+                1       无节点\n
+                其它    失败
+ */
+int list_proc(p_xt_list list, LIST_PROC proc, void *param)
+{
+    if (NULL == list || NULL == proc)
+    {
+        return -1;
+    }
+
+    if (LIST_TYPE_MPMC == list->type)
+    {
+        return list_mpmc_proc(list, proc, param);
+    }
+
+    if (LIST_TYPE_SPSC == list->type)
+    {
+        return list_spsc_proc(list, proc, param);
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    if (list->count <= 0)
+    {
+        pthread_mutex_unlock(&(list->mutex));
+        return 1;
+    }
+
+    int             pos   = list->head;
+    p_xt_list_block block = list->head_block;
+
+    for (int i = 0; i < list->count; i++)
+    {
+        if (LIST_BLOCK_SIZE == pos)
+        {
+            block = block->next;
+            pos = 0;
+        }
+
+        if (0 != proc(block->data[pos++], param))
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    return 0;
+}
+
+/**
+ *\brief                复制链表当前数据的快照,在锁外调用回调函数遍历快照,
+                        遍历期间其它线程可以入队出队,回调不会阻塞生产者
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数,返回非0时退出遍历
+ *\param[in]    param   自定义数据
+ *\attention    快照中只是数据指针,遍历期间数据指向的内存不能被释放
+ *\return       0       成功\n
+                1       无节点\n
+                -3      分配快照内存失败
+ */
+int list_proc_snapshot(p_xt_list list, LIST_PROC proc, void *param)
+{
+    if (NULL == list || NULL == proc)
+    {
+        return -1;
+    }
+
+    int    count;
+    void  *buf[LIST_BATCH_SIZE];
+    void **data = buf;
+
+    if (LIST_TYPE_MUTEX != list->type)
+    {
+        count = list_count(list);
+
+        if (count > LIST_BATCH_SIZE && NULL == (data = malloc(SV * count)))
+        {
+            E("malloc snapshot fail, count:%d", count);
+            return -3;
+        }
+
+        if (LIST_TYPE_MPMC == list->type)
+        {
+            count = list_mpmc_copy(list, data, count);
+        }
+        else
+        {
+            count = list_spsc_copy(list, data, count);
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&(list->mutex));
+
+        count = list->count;
+
+        if (count > LIST_BATCH_SIZE && NULL == (data = malloc(SV * count)))    // 快照需要一次复制全部数据,不分批
+        {
+            pthread_mutex_unlock(&(list->mutex));
+            E("malloc snapshot fail, count:%d", count);
+            return -3;
+        }
+
+        int             n;
+        int             copied = 0;
+        int             pos    = list->head;
+        p_xt_list_block block  = list->head_block;
+
+        while (copied < count)  // 按块复制
+        {
+            n = LIST_BLOCK_SIZE - pos;
+
+            if (n > count - copied)
+            {
+                n = count - copied;
+            }
+
+            memcpy(&(data[copied]), &(block->data[pos]), SV * n);
+
+            copied += n;
+            block   = block->next;
+            pos     = 0;
+        }
+
+        pthread_mutex_unlock(&(list->mutex));
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (0 != proc(data[i], param))
+        {
+            break;
+        }
+    }
+
+    if (data != buf)
+    {
+        free(data);
+    }
+
+    return (count > 0) ? 0 : 1;
+}
+
+/**
+ *\brief                在链表尾部添加多个数据,只加一次锁
+ *\param[in]    list    链表
+ *\param[in]    data    数据数组
+ *\param[in]    count   输入数据数量,输出添加的数量
+ *\return       0       成功\n
+                -2      无锁链表已满\n
+                -3      分配块失败,count为已添加的数量
+ */
+int list_tail_push_n(p_xt_list list, void **data, int *count)
+{
+    if (NULL == list || NULL == data || NULL == count || *count < 0)
+    {
+        return -1;
+    }
+
+    if (0 == *count)
+    {
+        return 0;
+    }
+
+    if (LIST_TYPE_MPMC == list->type)
+    {
+        return list_mpmc_push_n(list, data, count);
+    }
+
+    if (LIST_TYPE_SPSC == list->type)
+    {
+        return list_spsc_push_n(list, data, count);
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    int n = list_mutex_push_n(list, data, *count);
+
+    if (n > 0)
+    {
+        list_mutex_signal(list, n == list->count, n);
+    }
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    if (n < *count)
+    {
+        *count = n;
+        return -3;
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                从链表头部得到多个数据,只加一次锁
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   输入数组大小,输出得到的数量
+ *\return       0       成功\n
+                -2      无数据
+ */
+int list_head_pop_n(p_xt_list list, void **data, int *count)
+{
+    if (NULL == list || NULL == data || NULL == count || *count <= 0)
+    {
+        return -1;
+    }
+
+    if (LIST_TYPE_MPMC == list->type)
+    {
+        return list_mpmc_pop_n(list, data, count);
+    }
+
+    if (LIST_TYPE_SPSC == list->type)
+    {
+        return list_spsc_pop_n(list, data, count);
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    int n = list_mutex_pop_n(list, data, *count);
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    if (0 == n)
+    {
+        return -2;
+    }
+
+    *count = n;
+    return 0;
+}
+
+/**
+ *\brief                取出链表的全部数据,在锁外逐个调用回调函数
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数,返回值被忽略,所有节点都会被取出
+ *\param[in]    param   自定义数据
+ *\return       0       成功\n
+                1       无节点
+ */
+int list_drain(p_xt_list list, LIST_PROC proc, void *param)
+{
+    if (NULL == list || NULL == proc)
+    {
+        return -1;
+    }
+
+    int   ret = 1;
+    int   count;
+    void *data[LIST_BATCH_SIZE];
+
+    for (;;)
+    {
+        count = LIST_BATCH_SIZE;
+
+        if (0 != list_head_pop_n(list, data, &count))
+        {
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            proc(data[i], param);
+        }
+
+        ret = 0;
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                得到链表节点数量,并发时为近似值
+ *\param[in]    list    链表
+ *\return               节点数量
+ */
+int list_count(p_xt_list list)
+{
+    if (NULL == list)
+    {
+        return 0;
+    }
+
+    if (LIST_TYPE_MUTEX != list->type)
+    {
+        long count = (long)(ATOMIC_LOAD(&(list->push_pos)) - ATOMIC_LOAD(&(list->pop_pos)));
+
+        if (count < 0)          // 读取两个位置之间被其它线程修改
+        {
+            return 0;
+        }
+
+        return (count > list->size) ? list->size : (int)count;
+    }
+
+    return list->count;
+}
+
+/**
+ *\brief                从链表头部得到数据,无数据时等待
+ *\param[in]    list    链表
+ *\param[out]   data    数据
+ *\param[in]    timeout 等待毫秒数,0-不等待,-1-一直等待
+ *\return       0       成功\n
+                -2      超时或被list_wakeup唤醒
+ */
+int list_head_pop_wait(p_xt_list list, void **data, int timeout)
+{
+    if (NULL == list || NULL == data)
+    {
+        return -1;
+    }
+
+    int ret = list_head_pop(list, data);
+
+    if (-2 != ret || 0 == timeout)
+    {
+        return ret;
+    }
+
+    struct timeval  now;
+    struct timespec abstime;
+
+    if (timeout > 0)
+    {
+        gettimeofday(&now, NULL);
+        abstime.tv_sec  = now.tv_sec + timeout / 1000;
+        abstime.tv_nsec = now.tv_usec * 1000L + (timeout % 1000) * 1000000L;
+
+        if (abstime.tv_nsec >= 1000000000L)
+        {
+            abstime.tv_sec++;
+            abstime.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    long wakeup = list->wakeup;
+
+    ATOMIC_ADD(&(list->waiter), 1);
+    ATOMIC_FENCE();     // 先加等待数再读节点,与list_mpmc_signal配对,避免丢失唤醒
+
+    for (;;)
+    {
+        ret = (LIST_TYPE_MUTEX == list->type) ? list_mutex_pop(list, data) : list_lockfree_pop(list, data);
+
+        if (0 == ret || wakeup != list->wakeup)
+        {
+            break;
+        }
+
+        if (timeout > 0)
+        {
+            if (ETIMEDOUT == pthread_cond_timedwait(&(list->cond), &(list->mutex), &abstime))
+            {
+                ret = (LIST_TYPE_MUTEX == list->type) ? list_mutex_pop(list, data) : list_lockfree_pop(list, data);
+                break;
+            }
+        }
+        else
+        {
+            pthread_cond_wait(&(list->cond), &(list->mutex));
+        }
+    }
+
+    ATOMIC_ADD(&(list->waiter), -1);
+
+    pthread_mutex_unlock(&(list->mutex));
+
+    return ret;
+}
+
+/**
+ *\brief                唤醒所有在list_head_pop_wait中等待的线程
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_wakeup(p_xt_list list)
+{
+    if (NULL == list)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    list->wakeup++;
+    pthread_cond_broadcast(&(list->cond));
+
+    pthread_mutex_unlock(&(list->mutex));
+    return 0;
+}
+
+/**
+ *\brief                打开链表通知句柄,链表由空变为非空时句柄变为可读(有信号),
+                        可放入epoll或WaitForMultipleObjects中,句柄由list_uninit关闭
+ *\param[in]    list    链表
+ *\param[out]   notify  通知句柄
+ *\return       0       成功
+ */
+int list_notify_open(p_xt_list list, LIST_NOTIFY *notify)
+{
+    if (NULL == list || NULL == notify)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&(list->mutex));
+
+    if (LIST_NOTIFY_NULL == list->notify)
+    {
+#ifdef _WINDOWS
+        list->notify = CreateEvent(NULL, TRUE, FALSE, NULL);    // 手动复位
+#else
+        list->notify = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+        if (LIST_NOTIFY_NULL == list->notify)
+        {
+            pthread_mutex_unlock(&(list->mutex));
+            E("create notify fail");
+            return -2;
+        }
+
+        if (list_count(list) > 0)   // 已有数据
+        {
+            list_notify_set(list);
+        }
+    }
+
+    *notify = list->notify;
+
+    pthread_mutex_unlock(&(list->mutex));
+    return 0;
+}
+
+/**
+ *\brief                清除通知句柄的可读状态,清除后要取完链表中的数据
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_notify_clear(p_xt_list list)
+{
+    if (NULL == list || LIST_NOTIFY_NULL == list->notify)
+    {
+        return -1;
+    }
+
+#ifdef _WINDOWS
+    ResetEvent(list->notify);
+#else
+    unsigned long long value;
+    read(list->notify, &value, sizeof(value));
+#endif
     return 0;
 }
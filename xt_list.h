@@ -9,31 +9,112 @@
 #ifndef _XT_LIST_H_
 #define _XT_LIST_H_
 #include <pthread.h>
+#include "xt_utitly.h"
+
+/// 链表类型
+enum
+{
+    LIST_TYPE_MUTEX,            ///< 线程锁保护,按块增长,块取完后回收
+    LIST_TYPE_MPMC,             ///< 无锁多生产者多消费者,容量固定
+    LIST_TYPE_SPSC              ///< 无等待单生产者单消费者,容量固定,只能有一个入队线程和一个出队线程
+};
+
+#ifdef _WINDOWS
+    typedef void*   LIST_NOTIFY;                ///< 链表通知句柄,手动复位事件
+#else
+    typedef int     LIST_NOTIFY;                ///< 链表通知句柄,eventfd
+#endif
+
+typedef struct _xt_list_cell                ///  无锁链表节点
+{
+    volatile unsigned long  seq;            ///< 节点序号,用于判断节点可写或可读
+
+    void                   *data;           ///< 数据
+
+} xt_list_cell, *p_xt_list_cell;            ///< 无锁链表节点指针
+
+#define LIST_BLOCK_SIZE 256                     ///< 块中的节点数量
+
+typedef struct _xt_list_block               ///  链表块,LIST_TYPE_MUTEX的数据分块存放
+{
+    struct _xt_list_block  *next;           ///< 下一个块
+
+    void                   *data[LIST_BLOCK_SIZE];  ///< 数据
+
+} xt_list_block, *p_xt_list_block;          ///< 链表块指针
 
 /// 链表
 typedef struct _xt_list
 {
-    void          **data;       ///< 指向数据数组
+    int             type;       ///< 链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC,LIST_TYPE_SPSC
 
-    int             size;       ///< 数据数组大小
+    int             size;       ///< LIST_TYPE_MUTEX为空闲块缓存的节点数,无锁链表为容量
 
     int             count;      ///< 当前节点数量
 
-    int             head;       ///< 头节点数组下标
+    p_xt_list_block head_block; ///< 头节点所在块
+
+    p_xt_list_block tail_block; ///< 尾节点所在块
+
+    p_xt_list_block free_block; ///< 空闲块缓存
+
+    int             free_count; ///< 空闲块数量
 
-    int             tail;       ///< 尾节点数组下标
+    int             free_max;   ///< 空闲块缓存的最大数量,超出的块释放
+
+    int             head;       ///< 头节点在头块中的下标
+
+    int             tail;       ///< 下一个节点在尾块中的下标
 
     pthread_mutex_t mutex;      ///< 线程锁
 
+    pthread_cond_t  cond;       ///< 等待数据的条件变量
+
+    volatile long   waiter;     ///< 等待数据的线程数量
+
+    volatile long   wakeup;     ///< 唤醒次数,list_wakeup时增加
+
+    LIST_NOTIFY     notify;     ///< 链表由空变为非空时的通知句柄
+
+    p_xt_list_cell  cell;       ///< LIST_TYPE_MPMC节点数组
+
+    void          **data;       ///< LIST_TYPE_SPSC数据数组
+
+    unsigned long   mask;       ///< 无锁数组大小减1,大小为2的幂
+
+    char            pad0[CACHE_LINE_SIZE];                              ///< 填充,使写入位置独占缓存行
+
+    volatile unsigned long push_pos;                                    ///< 无锁写入位置
+
+    unsigned long   push_cache;                                         ///< LIST_TYPE_SPSC生产者缓存的读取位置
+
+    char            pad1[CACHE_LINE_SIZE - 2 * sizeof(unsigned long)];  ///< 填充,使读取位置独占缓存行
+
+    volatile unsigned long pop_pos;                                     ///< 无锁读取位置
+
+    unsigned long   pop_cache;                                          ///< LIST_TYPE_SPSC消费者缓存的写入位置
+
+    char            pad2[CACHE_LINE_SIZE - 2 * sizeof(unsigned long)];  ///< 填充
+
 } xt_list, *p_xt_list;          ///< 链表类型
 
 /**
- *\brief                链表初始化
+ *\brief                链表初始化,类型为LIST_TYPE_MUTEX
  *\param[in]    list    链表
  *\return       0       成功
  */
 int list_init(p_xt_list list);
 
+/**
+ *\brief                链表初始化
+ *\param[in]    list    链表
+ *\param[in]    type    链表类型:LIST_TYPE_MUTEX,LIST_TYPE_MPMC,LIST_TYPE_SPSC
+ *\param[in]    size    LIST_TYPE_MUTEX为空闲块缓存保留的节点数,无锁链表为容量,向上取2的幂,0为默认值
+ *\return       0       成功\n
+                -3      分配内存失败
+ */
+int list_init_ex(p_xt_list list, int type, unsigned int size);
+
 /**
  *\brief                链表反初始化
  *\param[in]    list    链表
@@ -45,18 +126,54 @@ int list_uninit(p_xt_list list);
  *\brief                在链表尾部添加数据
  *\param[in]    list    链表
  *\param[in]    data    数据
- *\return       0       成功
+ *\return       0       成功\n
+                -2      无锁链表已满\n
+                -3      分配块失败,链表不变
  */
 int list_tail_push(p_xt_list list, void *data);
 
 /**
  *\brief                从链表头部得到数据
  *\param[in]    list    链表
- *\param[out]   list    数据
- *\return       0       成功
+ *\param[out]   data    数据
+ *\return       0       成功\n
+                -2      无数据
  */
 int list_head_pop(p_xt_list list, void **data);
 
+/**
+ *\brief                从链表头部得到数据,无数据时等待
+ *\param[in]    list    链表
+ *\param[out]   data    数据
+ *\param[in]    timeout 等待毫秒数,0-不等待,-1-一直等待
+ *\return       0       成功\n
+                -2      超时或被list_wakeup唤醒
+ */
+int list_head_pop_wait(p_xt_list list, void **data, int timeout);
+
+/**
+ *\brief                唤醒所有在list_head_pop_wait中等待的线程
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_wakeup(p_xt_list list);
+
+/**
+ *\brief                打开链表通知句柄,链表由空变为非空时句柄变为可读(有信号),
+                        可放入epoll或WaitForMultipleObjects中,句柄由list_uninit关闭
+ *\param[in]    list    链表
+ *\param[out]   notify  通知句柄
+ *\return       0       成功
+ */
+int list_notify_open(p_xt_list list, LIST_NOTIFY *notify);
+
+/**
+ *\brief                清除通知句柄的可读状态,清除后要取完链表中的数据
+ *\param[in]    list    链表
+ *\return       0       成功
+ */
+int list_notify_clear(p_xt_list list);
+
 /**
  *\brief                回调函数
  *\param[in]    data    链表数据
@@ -67,12 +184,64 @@ int list_head_pop(p_xt_list list, void **data);
 typedef int (*LIST_PROC)(void *data, void *param);
 
 /**
- *\brief                调用指定的回调函数遍历链表
+ *\brief                调用指定的回调函数遍历链表,遍历时持有锁
  *\param[in]    list    链表
- *\param[in]    proc    回调函数
+ *\param[in]    proc    回调函数,返回非0时退出遍历
  *\param[in]    param   自定义数据
+ *\attention    无锁链表遍历时不能有其它线程出队
  *\return       0       成功
  */
 int list_proc(p_xt_list list, LIST_PROC proc, void *param);
 
+/**
+ *\brief                复制链表当前数据的快照,在锁外调用回调函数遍历快照,
+                        遍历期间其它线程可以入队出队,回调不会阻塞生产者
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数,返回非0时退出遍历
+ *\param[in]    param   自定义数据
+ *\attention    快照中只是数据指针,遍历期间数据指向的内存不能被释放
+ *\return       0       成功\n
+                1       无节点\n
+                -3      分配快照内存失败
+ */
+int list_proc_snapshot(p_xt_list list, LIST_PROC proc, void *param);
+
+/**
+ *\brief                在链表尾部添加多个数据,只加一次锁
+ *\param[in]    list    链表
+ *\param[in]    data    数据数组
+ *\param[in]    count   输入数据数量,输出添加的数量
+ *\return       0       成功\n
+                -2      无锁链表已满\n
+                -3      分配块失败,count为已添加的数量
+ */
+int list_tail_push_n(p_xt_list list, void **data, int *count);
+
+/**
+ *\brief                从链表头部得到多个数据,只加一次锁
+ *\param[in]    list    链表
+ *\param[out]   data    数据数组
+ *\param[in]    count   输入数组大小,输出得到的数量
+ *\return       0       成功\n
+                -2      无数据
+ */
+int list_head_pop_n(p_xt_list list, void **data, int *count);
+
+/**
+ *\brief                取出链表的全部数据,在锁外逐个调用回调函数
+ *\param[in]    list    链表
+ *\param[in]    proc    回调函数,返回值被忽略,所有节点都会被取出
+ *\param[in]    param   自定义数据
+ *\return       0       成功\n
+                1       无节点
+ */
+int list_drain(p_xt_list list, LIST_PROC proc, void *param);
+
+/**
+ *\brief                得到链表节点数量,并发时为近似值
+ *\param[in]    list    链表
+ *\return               节点数量
+ */
+int list_count(p_xt_list list);
+
 #endif
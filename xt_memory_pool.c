@@ -7,7 +7,16 @@
  *\brief    内存池模块实现
  */
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include "xt_memory_pool.h"
+#include "xt_utitly.h"
+
+#ifndef _WINDOWS
+    #include <unistd.h>
+    #include <sys/time.h>
+    #include <sys/mman.h>
+#endif
 
 #ifdef XT_LOG
     #include "xt_log.h"
@@ -27,6 +36,422 @@
     #endif
 #endif
 
+#define MEMORY_POOL_BATCH   64          ///< 向空闲链表批量添加内存块的数量
+#define MEMORY_POOL_DROP    0xFFFFFFFF  ///< 收缩时标记要释放的slab
+#define MEMORY_POOL_HUGE    0x200000    ///< 大页大小,使用大页时slab按此取整
+
+#if defined(_WIN64) || defined(__LP64__)
+    #define MEMORY_POOL_TAG_SHIFT   48  ///< 无锁栈顶中版本号的位置,64位系统用户空间地址不超过48位
+#else
+    #define MEMORY_POOL_TAG_SHIFT   32  ///< 无锁栈顶中版本号的位置
+#endif
+
+#define MEMORY_POOL_PTR_MASK    ((1ULL << MEMORY_POOL_TAG_SHIFT) - 1)                          ///< 无锁栈顶中地址的掩码
+#define MEMORY_POOL_PTR(top)    ((char*)(size_t)((top) & MEMORY_POOL_PTR_MASK))                 ///< 得到无锁栈顶的地址
+#define MEMORY_POOL_TOP(p, top) ((size_t)(p) | ((((top) >> MEMORY_POOL_TAG_SHIFT) + 1) << MEMORY_POOL_TAG_SHIFT))  ///< 新栈顶,版本号加1
+
+#define MEMORY_POOL_GUARD   16          ///< 调试模式下内存块前保护值的大小
+#define MEMORY_POOL_CANARY  0x5A5AA5A5  ///< 调试模式下的保护值
+#define MEMORY_POOL_FREE    1           ///< 调试模式下内存块空闲
+#define MEMORY_POOL_USED    2           ///< 调试模式下内存块使用中
+
+typedef struct _xt_memory_guard         ///  调试模式下内存块前的保护值
+{
+    unsigned int        canary;         ///< 保护值
+    volatile long       state;          ///< 状态:MEMORY_POOL_FREE,MEMORY_POOL_USED
+
+} xt_memory_guard, *p_xt_memory_guard;
+
+/**
+ *\brief                得到内存页大小
+ *\return               内存页大小
+ */
+static unsigned int memory_pool_page_size()
+{
+#ifdef _WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (unsigned int)info.dwPageSize;
+#else
+    long size = sysconf(_SC_PAGESIZE);
+    return (size > 0) ? (unsigned int)size : 4096;
+#endif
+}
+
+/**
+ *\brief                更新不在共享链表中的内存块数和最大值
+ *\param[in]    pool    池
+ *\param[in]    count   变化的数量,离开共享链表为正,回到共享链表为负
+ *\return               无
+ */
+static void memory_pool_used(p_xt_memory_pool pool, long count)
+{
+    long used = ATOMIC_ADD(&(pool->used), count);
+    long peak;
+
+    if (count <= 0)
+    {
+        return;
+    }
+
+    while (used > (peak = ATOMIC_LOAD(&(pool->peak))) && !ATOMIC_CAS(&(pool->peak), peak, used));
+
+    while (used > (peak = ATOMIC_LOAD(&(pool->period_peak))) && !ATOMIC_CAS(&(pool->period_peak), peak, used));
+}
+
+/**
+ *\brief                调试模式下设置内存块的保护值
+ *\param[in]    pool    池
+ *\param[in]    block   内存块
+ *\return               无
+ */
+static void memory_pool_guard_init(p_xt_memory_pool pool, char *block)
+{
+    unsigned int      canary = MEMORY_POOL_CANARY;
+    p_xt_memory_guard guard  = (p_xt_memory_guard)block;
+
+    guard->canary = MEMORY_POOL_CANARY;
+    guard->state  = MEMORY_POOL_FREE;
+    memcpy(block + MEMORY_POOL_GUARD + pool->mem_size, &canary, sizeof(canary));
+}
+
+/**
+ *\brief                调试模式下检查内存块前后的保护值是否被改写
+ *\param[in]    pool    池
+ *\param[in]    block   内存块
+ *\return       true    完好
+ */
+static bool memory_pool_guard_check(p_xt_memory_pool pool, char *block)
+{
+    unsigned int canary;
+
+    memcpy(&canary, block + MEMORY_POOL_GUARD + pool->mem_size, sizeof(canary));
+
+    if (MEMORY_POOL_CANARY != ((p_xt_memory_guard)block)->canary || MEMORY_POOL_CANARY != canary)
+    {
+        E("memory overwrite, mem:%p size:%u", block + MEMORY_POOL_GUARD, pool->mem_size);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *\brief                得到空闲内存块中存放无锁栈链接的位置,调试模式下跳过前保护值
+ *\param[in]    pool    池
+ *\param[in]    block   内存块
+ *\return               链接位置
+ */
+static char** memory_pool_link(p_xt_memory_pool pool, char *block)
+{
+    return (char**)((pool->flags & MEMORY_POOL_DEBUG) ? block + MEMORY_POOL_GUARD : block);
+}
+
+/**
+ *\brief                向空闲链表添加多个内存块,无锁时先在内存块中链接好,再一次比较交换放入栈顶
+ *\param[in]    pool    池
+ *\param[in]    block   内存块数组
+ *\param[in]    count   内存块数量
+ *\return               无
+ */
+static void memory_pool_free_push_n(p_xt_memory_pool pool, void **block, int count)
+{
+    if (0 == (pool->flags & MEMORY_POOL_LOCKFREE))
+    {
+        int n = count;
+
+        if (0 != list_tail_push_n(&(pool->free), block, &n))
+        {
+            E("push free block fail, count:%d", count - n);     // 没有放入的内存块不再使用,随所属内存区域一起释放
+        }
+
+        return;
+    }
+
+    unsigned long long top;
+    char             **last = memory_pool_link(pool, (char*)block[count - 1]);
+
+    for (int i = 0; i < count - 1; i++)
+    {
+        *memory_pool_link(pool, (char*)block[i]) = (char*)block[i + 1];
+    }
+
+    do
+    {
+        top   = ATOMIC_LOAD64(&(pool->top));
+        *last = MEMORY_POOL_PTR(top);
+    }
+    while (!ATOMIC_CAS64(&(pool->top), top, MEMORY_POOL_TOP(block[0], top)));
+}
+
+/**
+ *\brief                从空闲链表得到多个内存块
+ *\param[in]    pool    池
+ *\param[out]   block   内存块数组
+ *\param[in]    count   输入数组大小,输出得到的数量
+ *\return       0       成功\n
+ *              -2      无数据
+ */
+static int memory_pool_free_pop_n(p_xt_memory_pool pool, void **block, int *count)
+{
+    if (0 == (pool->flags & MEMORY_POOL_LOCKFREE))
+    {
+        return list_head_pop_n(&(pool->free), block, count);
+    }
+
+    int                n = 0;
+    char              *mem;
+    unsigned long long top;
+
+    while (n < *count)
+    {
+        do
+        {
+            top = ATOMIC_LOAD64(&(pool->top));
+            mem = MEMORY_POOL_PTR(top);
+
+            if (NULL == mem)
+            {
+                break;
+            }
+        }
+        // 读取链接时内存块可能已被其它线程取走并改写,此时版本号已变,比较交换失败后重试
+        while (!ATOMIC_CAS64(&(pool->top), top, MEMORY_POOL_TOP(*memory_pool_link(pool, mem), top)));
+
+        if (NULL == mem)
+        {
+            break;
+        }
+
+        block[n++] = mem;
+    }
+
+    *count = n;
+    return (n > 0) ? 0 : -2;
+}
+
+/**
+ *\brief                分配slab的内存,按选项使用大页,匿名映射或堆内存,失败时依次降级
+ *\param[in]    pool    池
+ *\param[in]    slab    slab,输入内存块数量,输出内存,大小,类型和取整后的内存块数量
+ *\return       0       成功
+ */
+static int memory_pool_slab_alloc(p_xt_memory_pool pool, p_xt_memory_slab slab)
+{
+    size_t size = (size_t)pool->stride * slab->count;
+    size_t page = memory_pool_page_size();
+
+    if (pool->flags & MEMORY_POOL_HUGEPAGE)
+    {
+        size = (size + MEMORY_POOL_HUGE - 1) & ~((size_t)MEMORY_POOL_HUGE - 1);
+#ifdef _WINDOWS
+        size_t large = GetLargePageMinimum();
+
+        if (large > 0 && 0 == size % large)
+        {
+            slab->mem = (char*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE); // 需要SeLockMemoryPrivilege权限
+            slab->backing = MEMORY_POOL_BACKING_HUGEPAGE;
+        }
+#else
+    #ifdef MAP_HUGETLB
+        slab->mem = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        slab->mem = (MAP_FAILED == slab->mem) ? NULL : slab->mem;
+        slab->backing = MEMORY_POOL_BACKING_HUGEPAGE;
+    #endif
+#endif
+    }
+    else if (pool->flags & MEMORY_POOL_MMAP)
+    {
+        size = (size + page - 1) & ~(page - 1);
+    }
+
+    if (NULL == slab->mem && (pool->flags & (MEMORY_POOL_MMAP | MEMORY_POOL_HUGEPAGE)))
+    {
+#ifdef _WINDOWS
+        slab->mem = (char*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        slab->backing = MEMORY_POOL_BACKING_MMAP;
+#else
+        slab->mem = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        slab->mem = (MAP_FAILED == slab->mem) ? NULL : slab->mem;
+        slab->backing = MEMORY_POOL_BACKING_MMAP;
+
+    #ifdef MADV_HUGEPAGE
+        if (NULL != slab->mem && (pool->flags & MEMORY_POOL_HUGEPAGE) && 0 == madvise(slab->mem, size, MADV_HUGEPAGE))
+        {
+            slab->backing = MEMORY_POOL_BACKING_THP;
+        }
+    #endif
+#endif
+    }
+
+    if (NULL == slab->mem)
+    {
+        size = (size_t)pool->stride * slab->count;
+
+        if (NULL == ALIGNED_MALLOC(slab->mem, pool->align, size))
+        {
+            return -3;
+        }
+
+        slab->backing = MEMORY_POOL_BACKING_HEAP;
+    }
+
+    slab->size  = size;
+    slab->count = (unsigned int)(size / pool->stride);  // 按页取整后多出的空间也切分为内存块
+    return 0;
+}
+
+/**
+ *\brief                释放slab的内存
+ *\param[in]    slab    slab
+ *\return               无
+ */
+static void memory_pool_slab_free(p_xt_memory_slab slab)
+{
+    if (MEMORY_POOL_BACKING_HEAP == slab->backing)
+    {
+        ALIGNED_FREE(slab->mem);
+    }
+    else
+    {
+#ifdef _WINDOWS
+        VirtualFree(slab->mem, 0, MEM_RELEASE);
+#else
+        munmap(slab->mem, slab->size);
+#endif
+    }
+
+    free(slab);
+}
+
+/**
+ *\brief                分配一个slab,切分为内存块放入空闲链表,调用者加锁
+ *\param[in]    pool    池
+ *\param[in]    count   内存块数量
+ *\param[out]   mem     不为NULL时第一个内存块直接返回,不放入空闲链表
+ *\return       0       成功
+ */
+static int memory_pool_grow(p_xt_memory_pool pool, unsigned int count, void **mem)
+{
+    char            *data;
+    void            *batch[MEMORY_POOL_BATCH];
+    int              n     = 0;
+    unsigned int     i     = 0;
+    p_xt_memory_slab slab  = (p_xt_memory_slab)calloc(1, sizeof(xt_memory_slab));
+
+    if (NULL == slab)
+    {
+        return -3;
+    }
+
+    slab->count = count;
+
+    if (0 != memory_pool_slab_alloc(pool, slab))
+    {
+        E("malloc slab fail, size:%u count:%u", pool->stride, count);
+        free(slab);
+        return -3;
+    }
+
+    data  = slab->mem;
+    count = slab->count;
+
+    if (pool->flags & MEMORY_POOL_DEBUG)
+    {
+        for (i = 0; i < count; i++)
+        {
+            memory_pool_guard_init(pool, data + (size_t)pool->stride * i);
+        }
+
+        i = 0;
+    }
+
+    slab->free  = 0;
+    slab->next  = pool->slab;
+    pool->slab  = slab;
+    pool->count += count;
+
+    if (NULL != mem)
+    {
+        *mem = data;
+        i = 1;
+    }
+
+    for (; i < count; i++)
+    {
+        batch[n++] = data + (size_t)pool->stride * i;
+
+        if (MEMORY_POOL_BATCH == n || i + 1 == count)
+        {
+            memory_pool_free_push_n(pool, batch, n);
+            n = 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                线程缓存反初始化,线程退出时调用,缓存的内存块放回共享链表
+ *\param[in]    param   线程缓存
+ *\return               无
+ */
+static void memory_pool_magazine_free(void *param)
+{
+    p_xt_memory_magazine magazine = (p_xt_memory_magazine)param;
+    p_xt_memory_pool     pool     = magazine->pool;
+    int                  count    = (int)magazine->count;
+
+    if (count > 0)
+    {
+        memory_pool_free_push_n(pool, magazine->mem, count);
+        memory_pool_used(pool, -count);
+    }
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    pool->stats.get     += magazine->get;
+    pool->stats.get_hit += magazine->get_hit;
+    pool->stats.put     += magazine->put;
+    pool->stats.put_hit += magazine->put_hit;
+    dlist_unlink(&(magazine->node));
+
+    pthread_mutex_unlock(&(pool->mutex));
+
+    free(magazine);
+}
+
+/**
+ *\brief                得到当前线程的缓存,没有时创建
+ *\param[in]    pool    池
+ *\return               线程缓存,失败时为NULL
+ */
+static p_xt_memory_magazine memory_pool_magazine(p_xt_memory_pool pool)
+{
+    p_xt_memory_magazine magazine = (p_xt_memory_magazine)pthread_getspecific(pool->key);
+
+    if (NULL != magazine)
+    {
+        return magazine;
+    }
+
+    magazine = (p_xt_memory_magazine)calloc(1, sizeof(xt_memory_magazine));
+
+    if (NULL == magazine)
+    {
+        return NULL;
+    }
+
+    magazine->pool = pool;
+
+    pthread_mutex_lock(&(pool->mutex));
+    dlist_push_tail(&(pool->magazine), &(magazine->node));
+    pthread_mutex_unlock(&(pool->mutex));
+
+    pthread_setspecific(pool->key, magazine);
+    return magazine;
+}
+
 /**
  *\brief                初始化内存池
  *\param[in]    pool    池
@@ -35,42 +460,81 @@
  *\return       0       成功
  */
 int memory_pool_init(p_xt_memory_pool pool, unsigned int size, unsigned int count)
+{
+    return memory_pool_init_ex(pool, size, count, 0);
+}
+
+/**
+ *\brief                初始化内存池,内存块从按缓存行对齐的连续slab中切分
+ *\param[in]    pool    池
+ *\param[in]    size    内存块大小
+ *\param[in]    count   初始内存块数量,要大于1,后续每次增加其一半
+ *\param[in]    flags   选项,MEMORY_POOL_PAGE_ALIGN,MEMORY_POOL_MAGAZINE,MEMORY_POOL_PACKED,MEMORY_POOL_DEBUG,MEMORY_POOL_HUGEPAGE等的组合
+ *\return       0       成功
+ */
+int memory_pool_init_ex(p_xt_memory_pool pool, unsigned int size, unsigned int count, unsigned int flags)
 {
     if (NULL == pool || 0 == size || count < 2)
     {
         return -1;
     }
 
-    pool->count = count;
+    if ((flags & MEMORY_POOL_LOCKFREE) && size < sizeof(void*))   // 空闲时内存块中要能放下无锁栈的链接
+    {
+        size = sizeof(void*);
+    }
+
+    // 调试模式下内存块前后各加保护值
+    unsigned int block = (flags & MEMORY_POOL_DEBUG) ? size + MEMORY_POOL_GUARD + sizeof(unsigned int) : size;
 
-    pool->mem_size = size;
+    // 大于缓存行的内存块按缓存行对齐,避免一个内存块跨越多余的缓存行,小内存块按指针对齐
+    unsigned int align = (block >= CACHE_LINE_SIZE) ? CACHE_LINE_SIZE : sizeof(void*);
 
+    if (flags & MEMORY_POOL_PACKED)
+    {
+        align = 16;
+    }
+
+    pool->mem_size    = size;
+    pool->stride      = (block + align - 1) & ~(align - 1);
+    pool->align       = (flags & MEMORY_POOL_PAGE_ALIGN) ? memory_pool_page_size() : CACHE_LINE_SIZE;
+    pool->flags       = flags;
+    pool->count       = 0;
+    pool->init_count  = count;
+    pool->released    = 0;
+    pool->slab        = NULL;
+    pool->top         = 0;
+    pool->used        = 0;
+    pool->peak        = 0;
+    pool->period_peak = 0;
+    pool->trim_run    = false;
+
+    memset(&(pool->stats), 0, sizeof(pool->stats));
+    dlist_init(&(pool->magazine));
     list_init(&(pool->free));
+    pthread_mutex_init(&(pool->mutex), NULL);
+    pthread_cond_init(&(pool->trim_cond), NULL);
 
-    for (unsigned int i = 0; i < count; i++)
+    if ((flags & MEMORY_POOL_MAGAZINE) && 0 != pthread_key_create(&(pool->key), memory_pool_magazine_free))
     {
-        list_tail_push(&(pool->free), malloc(size));
+        E("create magazine key fail");
+        pool->flags &= ~MEMORY_POOL_MAGAZINE;
     }
 
-    return 0;
-}
+    if (0 != memory_pool_grow(pool, count, NULL))
+    {
+        memory_pool_uninit(pool);
+        return -3;
+    }
 
-/**
- *\brief                链表删除内存
- *\param[in]    mem     内存
- *\param[in]    param   参数
- *\return       0       成功
- */
-int LIST_DEL_MEM(void *mem, void *param)
-{
-    free(mem);
     return 0;
 }
 
 /**
- *\brief                反初始化内存池
+ *\brief                反初始化内存池,按slab整块释放内存
  *\param[in]    pool    池
  *\return       0       成功
+ *\attention            其它线程的缓存在这里释放,调用后不能再使用内存池
  */
 int memory_pool_uninit(p_xt_memory_pool pool)
 {
@@ -79,10 +543,37 @@ int memory_pool_uninit(p_xt_memory_pool pool)
         return -1;
     }
 
-    list_proc(&(pool->free), LIST_DEL_MEM, NULL);
+    p_xt_memory_slab slab;
+    p_xt_dlist_node  node;
+    p_xt_dlist_node  next;
+
+    memory_pool_trim_stop(pool);
+
+    if (pool->flags & MEMORY_POOL_MAGAZINE)
+    {
+        pthread_key_delete(pool->key);  // 删除后线程退出时不再调用memory_pool_magazine_free
+
+        DLIST_FOREACH_SAFE(node, next, &(pool->magazine))
+        {
+            free(DLIST_ENTRY(node, xt_memory_magazine, node));
+        }
+
+        dlist_init(&(pool->magazine));
+        pool->flags &= ~MEMORY_POOL_MAGAZINE;
+    }
 
     list_uninit(&(pool->free));
 
+    while (NULL != pool->slab)
+    {
+        slab = pool->slab;
+        pool->slab = slab->next;
+        memory_pool_slab_free(slab);
+    }
+
+    pthread_cond_destroy(&(pool->trim_cond));
+    pthread_mutex_destroy(&(pool->mutex));
+
     pool->count = 0;
 
     pool->mem_size = 0;
@@ -90,6 +581,114 @@ int memory_pool_uninit(p_xt_memory_pool pool)
     return 0;
 }
 
+/**
+ *\brief                从共享链表得到内存,没有时分配新的slab
+ *\param[in]    pool    池
+ *\param[in]    mem     内存块
+ *\return       0       成功
+ */
+static int memory_pool_depot_get(p_xt_memory_pool pool, void **mem)
+{
+    int count = 1;
+    int ret   = memory_pool_free_pop_n(pool, mem, &count);
+
+    if (-2 == ret)   // 没有取到数据
+    {
+        pthread_mutex_lock(&(pool->mutex));
+
+        ret = memory_pool_free_pop_n(pool, mem, &count);    // 等锁时其它线程可能已分配了新的slab
+
+        if (-2 == ret)
+        {
+            ret = memory_pool_grow(pool, pool->count / 2, mem);  // 添加已使用的数量的一半
+        }
+
+        pthread_mutex_unlock(&(pool->mutex));
+    }
+
+    if (0 == ret)
+    {
+        memory_pool_used(pool, 1);
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                从内存池得到内存块,不经过调试检查
+ *\param[in]    pool    池
+ *\param[in]    mem     内存块
+ *\return       0       成功
+ */
+static int memory_pool_block_get(p_xt_memory_pool pool, void **mem)
+{
+    p_xt_memory_magazine magazine = (pool->flags & MEMORY_POOL_MAGAZINE) ? memory_pool_magazine(pool) : NULL;
+
+    if (NULL == magazine)
+    {
+        return memory_pool_depot_get(pool, mem);
+    }
+
+    magazine->get++;
+
+    if (magazine->count > 0)
+    {
+        magazine->get_hit++;
+        *mem = magazine->mem[--magazine->count];
+        return 0;
+    }
+
+    int count = MEMORY_POOL_MAGAZINE_SIZE / 2;   // 缓存为空,从共享链表批量取一半
+
+    if (0 == memory_pool_free_pop_n(pool, magazine->mem, &count))
+    {
+        memory_pool_used(pool, count);
+        magazine->count = (unsigned int)count;
+        *mem = magazine->mem[--magazine->count];
+        return 0;
+    }
+
+    return memory_pool_depot_get(pool, mem);
+}
+
+/**
+ *\brief                回收内存块到内存池,不经过调试检查
+ *\param[in]    pool    池
+ *\param[in]    mem     内存块
+ *\return       0       成功
+ */
+static int memory_pool_block_put(p_xt_memory_pool pool, void *mem)
+{
+    p_xt_memory_magazine magazine = (pool->flags & MEMORY_POOL_MAGAZINE) ? memory_pool_magazine(pool) : NULL;
+
+    if (NULL == magazine)
+    {
+        memory_pool_free_push_n(pool, &mem, 1);
+        memory_pool_used(pool, -1);
+        return 0;
+    }
+
+    magazine->put++;
+
+    if (magazine->count == MEMORY_POOL_MAGAZINE_SIZE)    // 缓存已满,把最早放入的一半放回共享链表,保留最近使用的
+    {
+        int count = MEMORY_POOL_MAGAZINE_SIZE / 2;
+
+        memory_pool_free_push_n(pool, magazine->mem, count);
+        memory_pool_used(pool, -count);
+
+        magazine->count -= (unsigned int)count;
+        memmove(magazine->mem, &(magazine->mem[count]), sizeof(void*) * magazine->count);
+    }
+    else
+    {
+        magazine->put_hit++;
+    }
+
+    magazine->mem[magazine->count++] = mem;
+    return 0;
+}
+
 /**
  *\brief                从内存池得到内存
  *\param[in]    pool    池
@@ -103,39 +702,435 @@ int memory_pool_get(p_xt_memory_pool pool, void **mem)
         return -1;
     }
 
-    int ret = list_head_pop(&(pool->free), mem);
+    int ret = memory_pool_block_get(pool, mem);
 
-    if (-2 == ret)   // 没有取到数据
+    if (0 != ret || 0 == (pool->flags & MEMORY_POOL_DEBUG))
+    {
+        return ret;
+    }
+
+    p_xt_memory_guard guard = (p_xt_memory_guard)*mem;
+
+    memory_pool_guard_check(pool, (char*)guard);    // 空闲时被改写,是回收后仍在使用
+
+    guard->state = MEMORY_POOL_USED;
+    *mem = (char*)guard + MEMORY_POOL_GUARD;
+    return 0;
+}
+
+/**
+ *\brief                回收内存到内存池
+ *\param[in]    pool    池
+ *\param[in]    mem     内存块
+ *\return       0       成功\n
+ *              -1      参数错误,调试模式下重复回收或不是内存池的内存
+ */
+int memory_pool_put(p_xt_memory_pool pool, void *mem)
+{
+    if (NULL == pool || NULL == mem)
+    {
+        return -1;
+    }
+
+    if (0 == (pool->flags & MEMORY_POOL_DEBUG))
+    {
+        return memory_pool_block_put(pool, mem);
+    }
+
+    char             *block = (char*)mem - MEMORY_POOL_GUARD;
+    p_xt_memory_guard guard = (p_xt_memory_guard)block;
+
+    if (!ATOMIC_CAS(&(guard->state), MEMORY_POOL_USED, MEMORY_POOL_FREE))
+    {
+        E("%s, mem:%p", (MEMORY_POOL_FREE == guard->state) ? "double put" : "bad memory", mem);
+        return -1;
+    }
+
+    memory_pool_guard_check(pool, block);
+    memory_pool_guard_init(pool, block);    // 恢复保护值,越界后继续使用时不重复报告
+    return memory_pool_block_put(pool, block);
+}
+
+/**
+ *\brief                得到内存池统计,其它线程的缓存计数不加锁读取,是近似值
+ *\param[in]    pool    池
+ *\param[out]   stats   统计
+ *\return       0       成功
+ */
+int memory_pool_stats(p_xt_memory_pool pool, p_xt_memory_pool_stats stats)
+{
+    if (NULL == pool || NULL == stats)
+    {
+        return -1;
+    }
+
+    p_xt_dlist_node      node;
+    p_xt_memory_slab     slab;
+    p_xt_memory_magazine magazine;
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    *stats = pool->stats;
+    stats->mem_size       = pool->mem_size;
+    stats->count          = pool->count;
+    stats->free_count     = (pool->flags & MEMORY_POOL_LOCKFREE) ? pool->count - (unsigned int)ATOMIC_LOAD(&(pool->used)) : (unsigned int)list_count(&(pool->free));
+    stats->peak           = (unsigned int)ATOMIC_LOAD(&(pool->peak));
+    stats->free_low       = (unsigned int)ATOMIC_LOAD(&(pool->period_peak));
+    stats->free_low       = (pool->count > stats->free_low) ? pool->count - stats->free_low : 0;   // 收缩后可能小于使用的最大值
+    stats->released       = pool->released;
+    stats->slab_count     = 0;
+    stats->backing        = 0;
+    stats->slab_size      = 0;
+    stats->magazine_count = 0;
+
+    for (slab = pool->slab; NULL != slab; slab = slab->next)
     {
-        *mem = malloc(pool->mem_size);
+        stats->slab_count++;
+        stats->backing   |= slab->backing;
+        stats->slab_size += slab->size;
+    }
+
+    DLIST_FOREACH(node, &(pool->magazine))
+    {
+        magazine = DLIST_ENTRY(node, xt_memory_magazine, node);
+        stats->free_count += magazine->count;
+        stats->get        += magazine->get;
+        stats->get_hit    += magazine->get_hit;
+        stats->put        += magazine->put;
+        stats->put_hit    += magazine->put_hit;
+        stats->magazine_count++;
+    }
 
-        int count = pool->count / 2;    // 添加已使用的数量的一半
+    pthread_mutex_unlock(&(pool->mutex));
 
-        for (int i = 0; i < count; i++)
+    unsigned long long total = stats->get + stats->put;
+
+    stats->in_use   = (stats->count > stats->free_count) ? stats->count - stats->free_count : 0;
+    stats->hit_rate = (total > 0) ? (double)(stats->get_hit + stats->put_hit) / (double)total : 0.0;
+    return 0;
+}
+
+/**
+ *\brief                比较slab地址,用于排序和查找
+ *\param[in]    a       slab指针
+ *\param[in]    b       slab指针
+ *\return               比较结果
+ */
+static int memory_pool_slab_compare(const void *a, const void *b)
+{
+    char *x = (*(p_xt_memory_slab*)a)->mem;
+    char *y = (*(p_xt_memory_slab*)b)->mem;
+    return (x > y) - (x < y);
+}
+
+/**
+ *\brief                查找内存块所在的slab
+ *\param[in]    pool    池
+ *\param[in]    slab    按地址排序的slab数组
+ *\param[in]    count   slab数量
+ *\param[in]    block   内存块
+ *\return               slab,没有找到时为NULL
+ */
+static p_xt_memory_slab memory_pool_slab_find(p_xt_memory_pool pool, p_xt_memory_slab *slab, unsigned int count, char *block)
+{
+    unsigned int low  = 0;
+    unsigned int high = count;
+    unsigned int mid;
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+
+        if (block < slab[mid]->mem)
         {
-            list_tail_push(&(pool->free), malloc(pool->mem_size));
+            high = mid;
         }
+        else if (block >= slab[mid]->mem + (size_t)pool->stride * slab[mid]->count)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            return slab[mid];
+        }
+    }
+
+    return NULL;
+}
 
-        pool->count += count;
+/**
+ *\brief                收缩内存池,释放内存块全部空闲的slab
+ *\param[in]    pool    池
+ *\param[in]    keep    释放后至少保留的内存块数量
+ *\return       0       成功
+ *\attention            线程缓存中的内存块不算空闲,其所在的slab不会释放\n
+ *                      无锁栈取内存块时会读取可能已被取走的内存块,MEMORY_POOL_LOCKFREE时不收缩
+ */
+int memory_pool_trim(p_xt_memory_pool pool, unsigned int keep)
+{
+    if (NULL == pool)
+    {
+        return -1;
     }
 
+    if (pool->flags & MEMORY_POOL_LOCKFREE)
+    {
+        return 0;
+    }
+
+    int               n;
+    unsigned int      i;
+    unsigned int      count    = 0;
+    unsigned int      total    = 0;
+    unsigned int      released = 0;
+    void             *batch[MEMORY_POOL_BATCH];
+    void            **block    = NULL;
+    p_xt_memory_slab *slab     = NULL;
+    p_xt_memory_slab *prev;
+    p_xt_memory_slab  find;
+    p_xt_memory_slab  drop     = NULL;
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    for (find = pool->slab; NULL != find; find = find->next)
+    {
+        find->free = 0;
+        count++;
+    }
+
+    if (count < 2 || pool->count <= keep)
+    {
+        pthread_mutex_unlock(&(pool->mutex));
+        return 0;
+    }
+
+    block = (void**)malloc(sizeof(void*) * pool->count);
+    slab  = (p_xt_memory_slab*)malloc(sizeof(p_xt_memory_slab) * count);
+
+    if (NULL == block || NULL == slab)
+    {
+        pthread_mutex_unlock(&(pool->mutex));
+        free(block);
+        free(slab);
+        return -3;
+    }
+
+    for (i = 0, find = pool->slab; NULL != find; find = find->next)
+    {
+        slab[i++] = find;
+    }
+
+    qsort(slab, count, sizeof(p_xt_memory_slab), memory_pool_slab_compare);
+
+    // 取出共享链表中全部空闲内存块,统计每个slab的空闲数量
+    while (total < pool->count)
+    {
+        n = (int)(pool->count - total);
+
+        if (0 != list_head_pop_n(&(pool->free), &(block[total]), &n))
+        {
+            break;
+        }
+
+        total += (unsigned int)n;
+    }
+
+    for (i = 0; i < total; i++)
+    {
+        if (NULL != (find = memory_pool_slab_find(pool, slab, count, (char*)block[i])))
+        {
+            find->free++;
+        }
+    }
+
+    // 释放全部空闲的slab,至少保留2个内存块,释放的slab的free标记为MEMORY_POOL_DROP
+    keep = (keep < 2) ? 2 : keep;
+
+    for (prev = &(pool->slab); NULL != *prev; )
+    {
+        find = *prev;
+
+        if (find->free == find->count && pool->count - find->count >= keep)
+        {
+            *prev = find->next;
+            pool->count -= find->count;
+            released += find->count;
+            find->free = MEMORY_POOL_DROP;
+            find->next = drop;
+            drop = find;
+            continue;
+        }
+
+        prev = &(find->next);
+    }
+
+    // 其余内存块放回共享链表
+    for (i = 0, n = 0; i < total; i++)
+    {
+        find = memory_pool_slab_find(pool, slab, count, (char*)block[i]);
+
+        if (NULL == find || MEMORY_POOL_DROP != find->free)
+        {
+            batch[n++] = block[i];
+        }
+
+        if (MEMORY_POOL_BATCH == n || (i + 1 == total && n > 0))
+        {
+            list_tail_push_n(&(pool->free), batch, &n);
+            n = 0;
+        }
+    }
+
+    pool->released += released;
+
+    pthread_mutex_unlock(&(pool->mutex));
+
+    while (NULL != drop)
+    {
+        find = drop;
+        drop = find->next;
+        memory_pool_slab_free(find);
+    }
+
+    if (released > 0)
+    {
+        D("trim %u blocks, count:%u", released, pool->count);
+    }
+
+    free(block);
+    free(slab);
     return 0;
 }
 
 /**
- *\brief                回收内存到内存池
+ *\brief                后台收缩线程,每个间隔按间隔内使用的最大值收缩
  *\param[in]    pool    池
- *\param[in]    mem     内存块
+ *\return               空
+ */
+static void* memory_pool_trim_thread(p_xt_memory_pool pool)
+{
+    D("begin");
+
+    int             ret;
+    unsigned int    keep;
+    struct timeval  now;
+    struct timespec abstime;
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    while (pool->trim_run)
+    {
+        gettimeofday(&now, NULL);
+        abstime.tv_sec  = now.tv_sec + pool->trim_interval;
+        abstime.tv_nsec = now.tv_usec * 1000L;
+
+        ret = pthread_cond_timedwait(&(pool->trim_cond), &(pool->mutex), &abstime);
+
+        if (!pool->trim_run || ETIMEDOUT != ret)
+        {
+            continue;
+        }
+
+        // 间隔内一直空闲的内存块不再需要,保留间隔内使用的最大值
+        keep = (unsigned int)ATOMIC_LOAD(&(pool->period_peak));
+        keep = (keep < pool->init_count) ? pool->init_count : keep;
+
+        ATOMIC_STORE(&(pool->period_peak), ATOMIC_LOAD(&(pool->used)));
+
+        pthread_mutex_unlock(&(pool->mutex));
+
+        memory_pool_trim(pool, keep);
+
+        pthread_mutex_lock(&(pool->mutex));
+    }
+
+    pthread_mutex_unlock(&(pool->mutex));
+
+    D("exit");
+    return NULL;
+}
+
+/**
+ *\brief                启动后台收缩,每个间隔释放间隔内一直空闲的内存,不低于初始数量
+ *\param[in]    pool    池
+ *\param[in]    interval 间隔,秒
  *\return       0       成功
  */
-int memory_pool_put(p_xt_memory_pool pool, void *mem)
+int memory_pool_trim_start(p_xt_memory_pool pool, unsigned int interval)
 {
-    if (NULL == pool || NULL == mem)
+    if (NULL == pool || 0 == interval || pool->trim_run)
+    {
+        return -1;
+    }
+
+    pool->trim_interval = interval;
+    pool->trim_run      = true;
+
+    int ret = pthread_create(&(pool->trim_tid), NULL, memory_pool_trim_thread, pool);
+
+    if (0 != ret)
+    {
+        E("create thread fail, ret:%d", ret);
+        pool->trim_run = false;
+        return -3;
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                停止后台收缩,反初始化时自动停止
+ *\param[in]    pool    池
+ *\return       0       成功
+ */
+int memory_pool_trim_stop(p_xt_memory_pool pool)
+{
+    if (NULL == pool)
     {
         return -1;
     }
 
-    list_tail_push(&(pool->free), mem);
+    pthread_mutex_lock(&(pool->mutex));
+
+    if (!pool->trim_run)
+    {
+        pthread_mutex_unlock(&(pool->mutex));
+        return 0;
+    }
+
+    pool->trim_run = false;
+    pthread_cond_signal(&(pool->trim_cond));
+
+    pthread_mutex_unlock(&(pool->mutex));
+
+    pthread_join(pool->trim_tid, NULL);
+    return 0;
+}
+
+/**
+ *\brief                放回当前线程的缓存,用于线程退出前内存池可能被其它线程反初始化时,之后再使用会重新创建缓存
+ *\param[in]    pool    池
+ *\return       0       成功
+ */
+int memory_pool_magazine_release(p_xt_memory_pool pool)
+{
+    if (NULL == pool)
+    {
+        return -1;
+    }
+
+    if (0 == (pool->flags & MEMORY_POOL_MAGAZINE))
+    {
+        return 0;
+    }
+
+    p_xt_memory_magazine magazine = (p_xt_memory_magazine)pthread_getspecific(pool->key);
+
+    if (NULL != magazine)
+    {
+        pthread_setspecific(pool->key, NULL);   // 线程退出时不再调用memory_pool_magazine_free
+        memory_pool_magazine_free(magazine);
+    }
 
     return 0;
 }
@@ -9,13 +9,107 @@
 #ifndef _XT_MEMORY_POOL_H_
 #define _XT_MEMORY_POOL_H_
 
+#include <pthread.h>
 #include "xt_list.h"
+#include "xt_dlist.h"
+
+#define MEMORY_POOL_MAGAZINE_SIZE   64  ///< 每个线程缓存的内存块数量,缓存空或满时与共享链表批量交换一半
+
+/// 内存池选项,可组合
+enum
+{
+    MEMORY_POOL_PAGE_ALIGN  = 0x01,     ///< slab按内存页对齐
+    MEMORY_POOL_MAGAZINE    = 0x02,     ///< 使用线程缓存,得到回收内存时不访问共享链表
+    MEMORY_POOL_PACKED      = 0x04,     ///< 内存块只按16字节对齐,不按缓存行填充
+    MEMORY_POOL_DEBUG       = 0x08,     ///< 调试模式,内存块前后加保护值,检查越界和重复回收
+    MEMORY_POOL_MMAP        = 0x10,     ///< slab使用匿名映射的内存,收缩时直接还给系统
+    MEMORY_POOL_HUGEPAGE    = 0x20,     ///< slab使用大页,不可用时使用透明大页或普通映射,包含MEMORY_POOL_MMAP
+    MEMORY_POOL_LOCKFREE    = 0x40,     ///< 空闲内存块使用无锁栈,后进先出,不能收缩
+};
+
+/// slab使用的内存类型,统计中为各类型的组合
+enum
+{
+    MEMORY_POOL_BACKING_HEAP     = 0x01,///< 堆内存
+    MEMORY_POOL_BACKING_MMAP     = 0x02,///< 匿名映射
+    MEMORY_POOL_BACKING_THP      = 0x04,///< 匿名映射,已建议使用透明大页
+    MEMORY_POOL_BACKING_HUGEPAGE = 0x08,///< 大页
+};
+
+typedef struct _xt_memory_slab          ///  一次分配的连续内存,切分为多个内存块
+{
+    struct _xt_memory_slab *next;       ///< 下一个slab
+    char                   *mem;        ///< 内存起始地址
+    size_t                  size;       ///< 内存大小
+    unsigned int            backing;    ///< 内存类型:MEMORY_POOL_BACKING_HEAP,...
+    unsigned int            count;      ///< 内存块数量
+    unsigned int            free;       ///< 收缩时统计的空闲内存块数量
+
+} xt_memory_slab, *p_xt_memory_slab;
+
+typedef struct _xt_memory_magazine      ///  线程缓存,每个线程每个内存池一个
+{
+    xt_dlist_node           node;       ///< 在内存池线程缓存链表中的节点
+    struct _xt_memory_pool *pool;       ///< 所属内存池
+    unsigned int            count;      ///< 缓存的内存块数量
+
+    unsigned long long      get;        ///< 得到次数
+    unsigned long long      get_hit;    ///< 从缓存得到的次数
+    unsigned long long      put;        ///< 回收次数
+    unsigned long long      put_hit;    ///< 回收到缓存的次数
+
+    void                   *mem[MEMORY_POOL_MAGAZINE_SIZE];    ///< 缓存的内存块,后进先出
+
+} xt_memory_magazine, *p_xt_memory_magazine;
+
+typedef struct _xt_memory_pool_stats    ///  内存池统计
+{
+    unsigned int        mem_size;       ///< 内存块大小
+    unsigned int        count;          ///< 总分配内存块数
+    unsigned int        free_count;     ///< 空闲内存块数,含线程缓存中的
+    unsigned int        in_use;         ///< 使用中的内存块数
+    unsigned int        peak;           ///< 使用中的内存块数最大值,含线程缓存中的
+    unsigned int        free_low;       ///< 上次收缩后共享链表中空闲内存块数的最小值
+    unsigned int        slab_count;     ///< slab数量
+    unsigned int        backing;        ///< slab使用的内存类型,MEMORY_POOL_BACKING_HEAP等的组合
+    size_t              slab_size;      ///< slab总大小
+    unsigned int        released;       ///< 收缩时已释放的内存块数
+    unsigned int        magazine_count; ///< 线程缓存数量
+
+    unsigned long long  get;            ///< 经过线程缓存的得到次数
+    unsigned long long  get_hit;        ///< 从线程缓存得到的次数
+    unsigned long long  put;            ///< 经过线程缓存的回收次数
+    unsigned long long  put_hit;        ///< 回收到线程缓存的次数
+    double              hit_rate;       ///< 线程缓存命中率,(get_hit + put_hit) / (get + put)
+
+} xt_memory_pool_stats, *p_xt_memory_pool_stats;
 
 typedef struct _xt_memory_pool          ///  内存池
 {
-    unsigned int    mem_size;           ///< 内存块大小
-    unsigned int    count;              ///< 总分配内存块数
-    xt_list         free;               ///< 空闲的内存块链表
+    unsigned int        mem_size;       ///< 内存块大小
+    unsigned int        stride;         ///< 内存块在slab中的间隔,按对齐后的大小
+    unsigned int        align;          ///< slab对齐值
+    unsigned int        flags;          ///< 选项
+    unsigned int        count;          ///< 总分配内存块数
+    unsigned int        init_count;     ///< 初始内存块数量,收缩时不低于此数量
+    unsigned int        released;       ///< 收缩时已释放的内存块数
+    p_xt_memory_slab    slab;           ///< 已分配的slab链表
+    pthread_mutex_t     mutex;          ///< 分配slab,收缩和增删线程缓存时的锁
+    xt_list             free;           ///< 空闲的内存块链表
+    volatile unsigned long long top;    ///< MEMORY_POOL_LOCKFREE时的空闲栈顶,高位为版本号,链接存放在空闲内存块中
+
+    volatile long       used;           ///< 不在共享链表中的内存块数
+    volatile long       peak;           ///< used最大值
+    volatile long       period_peak;    ///< 上次收缩后used最大值
+
+    bool                trim_run;       ///< 后台收缩线程是否运行
+    unsigned int        trim_interval;  ///< 后台收缩间隔,秒
+    pthread_t           trim_tid;       ///< 后台收缩线程
+    pthread_cond_t      trim_cond;      ///< 停止后台收缩的条件
+
+    pthread_key_t       key;            ///< 线程缓存的线程私有数据
+    xt_dlist            magazine;       ///< 全部线程缓存,用于统计和反初始化
+    xt_memory_pool_stats stats;         ///< 已退出线程的缓存统计
 
 } xt_memory_pool, *p_xt_memory_pool;
 
@@ -28,6 +122,16 @@ typedef struct _xt_memory_pool          ///  内存池
  */
 int memory_pool_init(p_xt_memory_pool pool, unsigned int size, unsigned int count);
 
+/**
+ *\brief                初始化内存池
+ *\param[in]    pool    池
+ *\param[in]    size    内存块大小
+ *\param[in]    count   初始内存块数量
+ *\param[in]    flags   选项,MEMORY_POOL_PAGE_ALIGN,MEMORY_POOL_MAGAZINE,MEMORY_POOL_PACKED,MEMORY_POOL_DEBUG,MEMORY_POOL_HUGEPAGE,MEMORY_POOL_LOCKFREE等的组合
+ *\return       0       成功
+ */
+int memory_pool_init_ex(p_xt_memory_pool pool, unsigned int size, unsigned int count, unsigned int flags);
+
 /**
  *\brief                反初始化内存池
  *\param[in]    pool    池
@@ -51,4 +155,42 @@ int memory_pool_get(p_xt_memory_pool pool, void **mem);
  */
 int memory_pool_put(p_xt_memory_pool pool, void *mem);
 
+/**
+ *\brief                得到内存池统计
+ *\param[in]    pool    池
+ *\param[out]   stats   统计
+ *\return       0       成功
+ */
+int memory_pool_stats(p_xt_memory_pool pool, p_xt_memory_pool_stats stats);
+
+/**
+ *\brief                收缩内存池,释放内存块全部空闲的slab
+ *\param[in]    pool    池
+ *\param[in]    keep    释放后至少保留的内存块数量
+ *\return       0       成功
+ */
+int memory_pool_trim(p_xt_memory_pool pool, unsigned int keep);
+
+/**
+ *\brief                启动后台收缩,每个间隔释放间隔内一直空闲的内存,不低于初始数量
+ *\param[in]    pool    池
+ *\param[in]    interval 间隔,秒
+ *\return       0       成功
+ */
+int memory_pool_trim_start(p_xt_memory_pool pool, unsigned int interval);
+
+/**
+ *\brief                停止后台收缩,反初始化时自动停止
+ *\param[in]    pool    池
+ *\return       0       成功
+ */
+int memory_pool_trim_stop(p_xt_memory_pool pool);
+
+/**
+ *\brief                放回当前线程的缓存,用于线程退出前内存池可能被其它线程反初始化时,之后再使用会重新创建缓存
+ *\param[in]    pool    池
+ *\return       0       成功
+ */
+int memory_pool_magazine_release(p_xt_memory_pool pool);
+
 #endif
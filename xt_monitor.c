@@ -33,6 +33,9 @@
     #define false   0
 #endif
 
+#define MONITOR_EVENT_BATCH 64      ///< 批量放入事件列表的最大事件数
+#define MONITOR_PUSH_RETRY  5000    ///< 事件列表满时最多连续重试的次数,每次等待1毫秒
+
 /**
  *\brief                    得到事件对象类型
  *\param[in]    path        路径
@@ -108,6 +111,49 @@ int monitor_blacklist(p_xt_monitor monitor, const char* txt)
     return 0;
 }
 
+/**
+ *\brief                    批量添加监控事件到事件列表,列表满时等待消费者取走事件,
+ *                          监控停止或重试次数用完时丢弃剩余的事件,避免消费者已停止时监控线程不能退出
+ *\param[in]    monitor     监控数据
+ *\param[in]    event       事件数组
+ *\param[in]    count       事件数量
+ *\return                   空
+ */
+static void monitor_push_event(p_xt_monitor monitor, p_xt_monitor_event *event, int count)
+{
+    int n;
+    int ret;
+    int retry = 0;
+
+    while (count > 0)
+    {
+        n   = count;
+        ret = list_tail_push_n(monitor->event, (void**)event, &n);
+
+        if (0 == ret || (-3 == ret && n > 0))   // 分配块失败时可能已添加一部分
+        {
+            event += n;
+            count -= n;
+            retry  = 0;
+            continue;
+        }
+
+        if (!(monitor->run) || ++retry > MONITOR_PUSH_RETRY)
+        {
+            W("event list full, drop %d event", count);
+
+            while (count-- > 0)
+            {
+                memory_pool_put(monitor->pool, *event++);
+            }
+
+            return;
+        }
+
+        Sleep(1);   // 列表已满,等待消费者取走事件
+    }
+}
+
 /**
  *\brief                    监控器线程
  *\param[in]    monitor     监控数据
@@ -148,7 +194,9 @@ void* monitor_thread(p_xt_monitor monitor)
     char obj_name[MNT_OBJNAME_SIZE]    = "";
     char obj_oldname[MNT_OBJNAME_SIZE] = "";
 
+    int event_count;
     p_xt_monitor_event event;
+    p_xt_monitor_event event_batch[MONITOR_EVENT_BATCH];
     FILE_NOTIFY_INFORMATION *notify;
 
     path_len = strlen(monitor->localpath);
@@ -184,6 +232,8 @@ void* monitor_thread(p_xt_monitor monitor)
             continue;
         }
 
+        event_count = 0;
+
         while (monitor->run)
         {
             D("NextEntryOffset:%d", notify->NextEntryOffset);
@@ -251,7 +301,13 @@ void* monitor_thread(p_xt_monitor monitor)
                 event->monitor_id = monitor->id;
                 strncpy_s(event->obj_name, MNT_OBJNAME_SIZE, obj_name, MNT_OBJNAME_SIZE - 1);
                 strncpy_s(event->obj_oldname, MNT_OBJNAME_SIZE, obj_oldname, MNT_OBJNAME_SIZE - 1);
-                list_tail_push(monitor->event, event);
+                event_batch[event_count++] = event;
+
+                if (MONITOR_EVENT_BATCH == event_count)
+                {
+                    monitor_push_event(monitor, event_batch, event_count);
+                    event_count = 0;
+                }
             }
 
             if (0 == notify->NextEntryOffset)
@@ -262,6 +318,7 @@ void* monitor_thread(p_xt_monitor monitor)
             notify = (FILE_NOTIFY_INFORMATION*)((char*)notify + notify->NextEntryOffset);
         }
 
+        monitor_push_event(monitor, event_batch, event_count);  // 一次通知中的事件批量放入列表
     }
 
     D("exit");
@@ -271,7 +328,8 @@ void* monitor_thread(p_xt_monitor monitor)
 /**
  *\brief                    初始化监控器
  *\param[in]    monitor     监控数据
- *\param[in]    list        监控事件列表
+ *\param[in]    list        监控事件列表,只有一个线程取事件时可用LIST_TYPE_SPSC类型的链表,
+                            监控线程是唯一的生产者,入队不加锁
  *\param[in]    pool        内存池
  *\return       0           成功
  */
@@ -77,7 +77,8 @@ typedef struct _xt_monitor_event                                        ///  监
 /**
  *\brief                    初始化监控器
  *\param[in]    monitor     监控数据
- *\param[in]    list        监控事件列表
+ *\param[in]    list        监控事件列表,只有一个线程取事件时可用LIST_TYPE_SPSC类型的链表,
+                            监控线程是唯一的生产者,入队不加锁
  *\param[in]    pool        内存池
  *\return       0           成功
  */
@@ -0,0 +1,256 @@
+/**
+ *\file     xt_ring.h
+ *\note     UTF-8
+ *\author   xt
+ *\version  1.0.0
+ *\date     2026.10.16
+ *\brief    按值存放数据的环形队列,由宏生成指定类型的实现
+ *
+ * 数据直接存放在按缓存行对齐的连续数组中,入队出队不需要为每个数据分配内存\n
+ * 头文件中用XT_RING_DECLARE(name, type)声明,在一个源文件中用XT_RING_DEFINE(name, type)实现\n
+ * 生成的类型和接口:\n
+ *   name, p_name                                       队列类型\n
+ *   int name_init(p_name ring, unsigned int size)      初始化,size为初始容量,0为默认值\n
+ *   int name_uninit(p_name ring)                       反初始化\n
+ *   int name_tail_push(p_name ring, const type *data)  在尾部添加数据,满时容量扩大一倍\n
+ *   int name_head_pop(p_name ring, type *data)         从头部得到数据\n
+ *   int name_head_pop_n(p_name ring, type *data, int *count)   从头部得到多个数据\n
+ *   int name_proc(p_name ring, name_PROC proc, void *param)    遍历队列\n
+ *   int name_count(p_name ring)                        得到数据数量
+ */
+#ifndef _XT_RING_H_
+#define _XT_RING_H_
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "xt_utitly.h"
+
+#ifdef _WINDOWS
+    #include <malloc.h>
+#endif
+
+#define RING_SIZE   256                                                 ///< 默认初始容量
+
+/**
+ *\brief                    声明环形队列类型和接口
+ *\param[in]    name        队列类型名称,也是接口名称前缀
+ *\param[in]    type        数据类型
+ */
+#define XT_RING_DECLARE(name, type)                                     \
+                                                                        \
+typedef int (*name##_PROC)(type *data, void *param);                    \
+                                                                        \
+typedef struct _##name                                                  \
+{                                                                       \
+    type           *data;       /* 数据数组,按缓存行对齐 */              \
+    unsigned int    size;       /* 数组大小,2的幂 */                     \
+    unsigned int    head;       /* 读取位置,不回绕 */                    \
+    unsigned int    tail;       /* 写入位置,不回绕 */                    \
+    pthread_mutex_t mutex;      /* 线程锁 */                             \
+                                                                        \
+} name, *p_##name;                                                      \
+                                                                        \
+int name##_init(p_##name ring, unsigned int size);                      \
+int name##_uninit(p_##name ring);                                       \
+int name##_tail_push(p_##name ring, const type *data);                  \
+int name##_head_pop(p_##name ring, type *data);                         \
+int name##_head_pop_n(p_##name ring, type *data, int *count);           \
+int name##_proc(p_##name ring, name##_PROC proc, void *param);          \
+int name##_count(p_##name ring);
+
+/**
+ *\brief                    实现环形队列接口,返回值:0-成功,-1-参数错误,-2-无数据,-3-分配内存失败
+ *\param[in]    name        队列类型名称,与XT_RING_DECLARE相同
+ *\param[in]    type        数据类型,与XT_RING_DECLARE相同
+ */
+#define XT_RING_DEFINE(name, type)                                      \
+                                                                        \
+static void name##_copy(p_##name ring, type *data, unsigned int count)  \
+{                                                                       \
+    unsigned int pos   = ring->head & (ring->size - 1);                 \
+    unsigned int first = ring->size - pos;                              \
+                                                                        \
+    if (first > count)                                                  \
+    {                                                                   \
+        first = count;                                                  \
+    }                                                                   \
+                                                                        \
+    memcpy(data, &(ring->data[pos]), sizeof(type) * first);             \
+    memcpy(&(data[first]), ring->data, sizeof(type) * (count - first)); \
+}                                                                       \
+                                                                        \
+static int name##_grow(p_##name ring)                                   \
+{                                                                       \
+    type        *data;                                                  \
+    unsigned int count = ring->tail - ring->head;                       \
+                                                                        \
+    if (NULL == ALIGNED_MALLOC(data, CACHE_LINE_SIZE, sizeof(type) * ring->size * 2)) \
+    {                                                                   \
+        return -3;                                                      \
+    }                                                                   \
+                                                                        \
+    name##_copy(ring, data, count);                                     \
+    ALIGNED_FREE(ring->data);                                           \
+                                                                        \
+    ring->data  = data;                                                 \
+    ring->size *= 2;                                                    \
+    ring->head  = 0;                                                    \
+    ring->tail  = count;                                                \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_init(p_##name ring, unsigned int size)                       \
+{                                                                       \
+    unsigned int cap = 2;                                               \
+                                                                        \
+    if (NULL == ring)                                                   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    if (size < 2)                                                       \
+    {                                                                   \
+        size = RING_SIZE;                                               \
+    }                                                                   \
+                                                                        \
+    while (cap < size)                                                  \
+    {                                                                   \
+        cap <<= 1;                                                      \
+    }                                                                   \
+                                                                        \
+    if (NULL == ALIGNED_MALLOC(ring->data, CACHE_LINE_SIZE, sizeof(type) * cap)) \
+    {                                                                   \
+        return -3;                                                      \
+    }                                                                   \
+                                                                        \
+    ring->size = cap;                                                   \
+    ring->head = 0;                                                     \
+    ring->tail = 0;                                                     \
+    pthread_mutex_init(&(ring->mutex), NULL);                           \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_uninit(p_##name ring)                                        \
+{                                                                       \
+    if (NULL == ring)                                                   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    ALIGNED_FREE(ring->data);                                           \
+    ring->data = NULL;                                                  \
+    ring->size = 0;                                                     \
+    ring->head = 0;                                                     \
+    ring->tail = 0;                                                     \
+    pthread_mutex_destroy(&(ring->mutex));                              \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_tail_push(p_##name ring, const type *data)                   \
+{                                                                       \
+    if (NULL == ring || NULL == data)                                   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    pthread_mutex_lock(&(ring->mutex));                                 \
+                                                                        \
+    if (ring->tail - ring->head == ring->size && 0 != name##_grow(ring))\
+    {                                                                   \
+        pthread_mutex_unlock(&(ring->mutex));                           \
+        return -3;                                                      \
+    }                                                                   \
+                                                                        \
+    ring->data[ring->tail & (ring->size - 1)] = *data;                  \
+    ring->tail++;                                                       \
+                                                                        \
+    pthread_mutex_unlock(&(ring->mutex));                               \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_head_pop(p_##name ring, type *data)                          \
+{                                                                       \
+    if (NULL == ring || NULL == data)                                   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    pthread_mutex_lock(&(ring->mutex));                                 \
+                                                                        \
+    if (ring->tail == ring->head)                                       \
+    {                                                                   \
+        pthread_mutex_unlock(&(ring->mutex));                           \
+        return -2;                                                      \
+    }                                                                   \
+                                                                        \
+    *data = ring->data[ring->head & (ring->size - 1)];                  \
+    ring->head++;                                                       \
+                                                                        \
+    pthread_mutex_unlock(&(ring->mutex));                               \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_head_pop_n(p_##name ring, type *data, int *count)            \
+{                                                                       \
+    if (NULL == ring || NULL == data || NULL == count || *count <= 0)   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    pthread_mutex_lock(&(ring->mutex));                                 \
+                                                                        \
+    unsigned int n = ring->tail - ring->head;                           \
+                                                                        \
+    if (0 == n)                                                         \
+    {                                                                   \
+        pthread_mutex_unlock(&(ring->mutex));                           \
+        return -2;                                                      \
+    }                                                                   \
+                                                                        \
+    if (n > (unsigned int)*count)                                       \
+    {                                                                   \
+        n = (unsigned int)*count;                                       \
+    }                                                                   \
+                                                                        \
+    name##_copy(ring, data, n);                                         \
+    ring->head += n;                                                    \
+                                                                        \
+    pthread_mutex_unlock(&(ring->mutex));                               \
+                                                                        \
+    *count = (int)n;                                                    \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_proc(p_##name ring, name##_PROC proc, void *param)           \
+{                                                                       \
+    if (NULL == ring || NULL == proc)                                   \
+    {                                                                   \
+        return -1;                                                      \
+    }                                                                   \
+                                                                        \
+    pthread_mutex_lock(&(ring->mutex));                                 \
+                                                                        \
+    if (ring->tail == ring->head)                                       \
+    {                                                                   \
+        pthread_mutex_unlock(&(ring->mutex));                           \
+        return 1;                                                       \
+    }                                                                   \
+                                                                        \
+    for (unsigned int i = ring->head; i != ring->tail; i++)             \
+    {                                                                   \
+        if (0 != proc(&(ring->data[i & (ring->size - 1)]), param))      \
+        {                                                               \
+            break;                                                      \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    pthread_mutex_unlock(&(ring->mutex));                               \
+    return 0;                                                           \
+}                                                                       \
+                                                                        \
+int name##_count(p_##name ring)                                         \
+{                                                                       \
+    return (NULL == ring) ? 0 : (int)(ring->tail - ring->head);         \
+}
+
+#endif
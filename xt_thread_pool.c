@@ -6,9 +6,23 @@
  *\date     2013.8.16
  *\brief    线程池模块实现
  */
+#if !defined(_WINDOWS) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE     // pthread_setaffinity_np,pthread_setname_np
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
 #include "xt_thread_pool.h"
 #include "xt_utitly.h"
 
+#ifndef _WINDOWS
+    #include <unistd.h>
+    #include <sched.h>
+    #include <sys/time.h>
+#endif
+
 #ifdef XT_LOG
     #include "xt_log.h"
 #else
@@ -27,135 +41,2002 @@
     #endif
 #endif
 
+#define THREAD_POOL_BATCH   16      ///< 线程每次从队列中取出的最大任务数
+#define THREAD_POOL_SPIN    16      ///< 自适应自旋的最小次数,自旋失败后减半但不低于此值
+#define THREAD_POOL_DEQUE   1024    ///< 工作窃取时每个线程双端队列的默认容量
+#define THREAD_POOL_AGING   200     ///< 低优先级队列默认提升时间(毫秒)
+#define THREAD_POOL_TASK    1024    ///< 任务内存池初始任务数量
+#define THREAD_POOL_KEEP    60000   ///< 多余线程默认空闲退出时间(毫秒)
+#define THREAD_POOL_DEPTH   64      ///< 默认增加线程的队列任务数
+#define THREAD_POOL_WAIT    100     ///< 默认增加线程的队列等待时间(毫秒)
+
+#ifdef _WINDOWS
+    #define THREAD_POOL_CPU_MAX (sizeof(DWORD_PTR) * 8)     ///< 可绑定的CPU编号上限,亲和掩码的位数
+#else
+    #define THREAD_POOL_CPU_MAX CPU_SETSIZE                 ///< 可绑定的CPU编号上限
+#endif
+
+#define THREAD_POOL_THREAD_NAME 16  ///< 线程名称缓冲区大小,LINUX下线程名称不超过15字节,超过时截断
+
+#define THREAD_POOL_LOOP_SPLIT  8   ///< 并行循环自动计算段长时,每个参与线程平均分到的段数
+
+typedef struct _xt_thread_pool_loop                     ///  并行循环或归约数据
+{
+    volatile unsigned __int64       next;               ///< 下一段的开始位置
+
+    unsigned __int64                end;                ///< 结束位置,不含
+
+    unsigned __int64                grain;              ///< 每段的最小长度
+
+    unsigned int                    ways;               ///< 参与的线程数量,含调用线程
+
+    XT_THREAD_POOL_FOR_CALLBACK     proc;               ///< 并行循环回调,归约时为NULL
+
+    XT_THREAD_POOL_MAP_CALLBACK     map;                ///< 归约回调,并行循环时为NULL
+
+    void*                           ctx;                ///< 回调接口参数
+
+    char*                           value;              ///< 各参与线程的归约结果,共ways个
+
+    size_t                          size;               ///< 归约结果的大小
+
+    volatile long                   slot;               ///< 已使用的归约结果数量
+
+} xt_thread_pool_loop, *p_xt_thread_pool_loop;
+
 /**
- *\brief                线程池线程
- *\return               空
+ *\brief                计算超时的绝对时间
+ *\param[out]   abstime 绝对时间
+ *\param[in]    timeout 超时时间(毫秒)
+ *\return               无
  */
-void* thread_pool_thread(p_xt_thread_pool pool)
+static void thread_pool_abstime(struct timespec *abstime, unsigned int timeout)
 {
-    D("begin");
+    struct timeval now;
 
-    p_xt_thread_pool_task task;
+    gettimeofday(&now, NULL);
+    abstime->tv_sec  = now.tv_sec + timeout / 1000;
+    abstime->tv_nsec = now.tv_usec * 1000L + (timeout % 1000) * 1000000L;
+
+    if (abstime->tv_nsec >= 1000000000L)
+    {
+        abstime->tv_sec++;
+        abstime->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ *\brief                任务结果或任务组中的任务完成后唤醒等待的线程
+ *\param[in]    pool    线程池
+ *\return               无
+ */
+static void thread_pool_done(p_xt_thread_pool pool)
+{
+    ATOMIC_FENCE();     // 先写完成状态再读等待数,与thread_pool_wait中先加等待数再读完成状态配对
+
+    if (ATOMIC_LOAD(&(pool->done_waiter)) > 0)
+    {
+        pthread_mutex_lock(&(pool->done_mutex));
+        pool->done_signal++;
+        pthread_cond_broadcast(&(pool->done_cond));
+        pthread_mutex_unlock(&(pool->done_mutex));
+    }
+}
+
+static void thread_pool_grow(p_xt_thread_pool pool, p_xt_thread_pool_worker worker);    // 增加线程,定义在创建线程之后
+
+/**
+ *\brief                执行任务
+ *\param[in]    pool    线程池
+ *\param[in]    data    任务数据,不在任务内存池中
+ *\return               无
+ */
+static void thread_pool_exec(p_xt_thread_pool pool, p_xt_thread_pool_task data)
+{
+    // 添加任务时线程可能都在休眠,开始执行后所有线程都忙时再检查一次是否要增加线程
+    if (ATOMIC_ADD(&(pool->process_count), 1) >= ATOMIC_LOAD(&(pool->thread_count)) &&
+        (long)pool->thread_max > ATOMIC_LOAD(&(pool->thread_count)))
+    {
+        thread_pool_grow(pool, NULL);
+    }
+
+    data->proc(data->param);
+    ATOMIC_ADD(&(pool->process_count), -1);
 
-    while(pool->run)
+    if (NULL != data->group)
     {
-        task = NULL;
+        ATOMIC_ADD(&(data->group->count), -1);
+        thread_pool_done(pool);
+    }
+}
+
+/**
+ *\brief                从队列或双端队列中取出任务后减少队列中的任务数,有等待空位的线程时唤醒,
+ *                      取出后就释放空位,线程成批取出的任务还没有执行时也可以添加或丢弃任务
+ *\param[in]    pool    线程池
+ *\param[in]    count   取出的任务数量
+ *\return               无
+ */
+static void thread_pool_release(p_xt_thread_pool pool, int count)
+{
+    if (0 == pool->capacity)
+    {
+        return;
+    }
+
+    ATOMIC_ADD(&(pool->queued), -count);
+    ATOMIC_FENCE();     // 先减任务数再读等待数,与thread_pool_block中先加等待数再读任务数配对
+
+    if (ATOMIC_LOAD(&(pool->full_waiter)) > 0)
+    {
+        pthread_mutex_lock(&(pool->full_mutex));
 
-        if (0 != list_head_pop(&(pool->task_queue), &task))
+        if (count > 1)
         {
-            msleep(5);
-            continue;
+            pthread_cond_broadcast(&(pool->full_cond));
+        }
+        else
+        {
+            pthread_cond_signal(&(pool->full_cond));
         }
 
-        if (NULL != task)
+        pthread_mutex_unlock(&(pool->full_mutex));
+    }
+}
+
+/**
+ *\brief                执行任务并释放
+ *\param[in]    pool    线程池
+ *\param[in]    task    任务
+ *\return               无
+ */
+static void thread_pool_run(p_xt_thread_pool pool, p_xt_thread_pool_task task)
+{
+    if (NULL == task)
+    {
+        E("get task null");
+        return;
+    }
+
+    xt_thread_pool_task data = *task;
+
+    memory_pool_put(&(pool->task_pool), task);  // 先放回,本线程添加的下一个任务可重复使用
+
+    thread_pool_exec(pool, &data);
+}
+
+/**
+ *\brief                有新任务时唤醒休眠的线程
+ *\param[in]    pool    线程池
+ *\param[in]    count   新任务数量,大于1时唤醒全部休眠的线程
+ *\return               无
+ */
+static void thread_pool_notify(p_xt_thread_pool pool, int count)
+{
+    ATOMIC_FENCE();     // 先放入任务再读休眠数,与thread_pool_park中先加休眠数再取任务配对
+
+    if (ATOMIC_LOAD(&(pool->idle)) > 0)
+    {
+        pthread_mutex_lock(&(pool->idle_mutex));
+
+        pool->signal++;
+
+        if (count > 1)
         {
-            pool->thread_count++;
-            task->proc(task->param);
-            pool->thread_count--;
+            pthread_cond_broadcast(&(pool->idle_cond));
         }
         else
         {
-            E("get task null");
+            pthread_cond_signal(&(pool->idle_cond));
         }
+
+        pthread_mutex_unlock(&(pool->idle_mutex));
     }
+}
 
-    D("exit");
-    return NULL;
+/**
+ *\brief                任务放入本线程双端队列的底部,只能由本线程调用
+ *\param[in]    worker  工作线程
+ *\param[in]    task    任务
+ *\return       0       成功\n
+ *              -2      队列已满
+ */
+static int thread_pool_deque_push(p_xt_thread_pool_worker worker, p_xt_thread_pool_task task)
+{
+    unsigned long b = worker->bottom;
+    unsigned long t = ATOMIC_LOAD(&(worker->top));
+
+    if (b - t > worker->mask)
+    {
+        return -2;
+    }
+
+    worker->deque[b & worker->mask] = task;
+    ATOMIC_STORE(&(worker->bottom), b + 1);     // 先写任务再移动底部,窃取线程看到底部时任务已写入
+    return 0;
 }
 
 /**
- *\brief                线程池初始化
- *\param[in]    pool    线程池
- *\attention    pool    需要转递到线线程中,不要释放此内存,否则会野指针
- *\param[in]    count   线程数量
- *\return       0       成功
+ *\brief                从本线程双端队列的底部取出任务,只能由本线程调用,后放入的先取出
+ *\param[in]    worker  工作线程
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      队列为空
  */
-int thread_pool_init(p_xt_thread_pool pool, unsigned int count)
+static int thread_pool_deque_pop(p_xt_thread_pool_worker worker, p_xt_thread_pool_task *task)
 {
-    if (NULL == pool || 0 == count)
+    unsigned long b = worker->bottom - 1;
+    unsigned long t;
+
+    ATOMIC_STORE(&(worker->bottom), b);
+    ATOMIC_FENCE();     // 先移动底部再读顶部,与thread_pool_deque_steal中先读顶部再读底部配对
+
+    t = worker->top;
+
+    if ((long)(b - t) < 0)
     {
-        return -1;
+        ATOMIC_STORE(&(worker->bottom), b + 1);
+        return -2;
     }
 
-    int ret = list_init(&(pool->task_queue));
+    *task = worker->deque[b & worker->mask];
 
-    if (0 != ret)
+    if (b != t)
+    {
+        return 0;
+    }
+
+    // 只剩最后一个任务时与窃取线程竞争顶部
+    int ret = ATOMIC_CAS(&(worker->top), t, t + 1) ? 0 : -2;
+
+    ATOMIC_STORE(&(worker->bottom), b + 1);
+    return ret;
+}
+
+/**
+ *\brief                从其它线程双端队列的顶部窃取任务,先放入的先窃取
+ *\param[in]    victim  被窃取的工作线程
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      队列为空或与其它线程竞争失败
+ */
+static int thread_pool_deque_steal(p_xt_thread_pool_worker victim, p_xt_thread_pool_task *task)
+{
+    unsigned long t = ATOMIC_LOAD(&(victim->top));
+
+    ATOMIC_FENCE();
+
+    unsigned long b = ATOMIC_LOAD(&(victim->bottom));
+
+    if ((long)(b - t) <= 0)
     {
         return -2;
     }
 
-    pool->run           = true;
-    pool->thread_count  = count;
-    pool->process_count = 0;
+    p_xt_thread_pool_task data = victim->deque[t & victim->mask];
+
+    if (!ATOMIC_CAS(&(victim->top), t, t + 1))
+    {
+        return -2;
+    }
+
+    *task = data;
+    return 0;
+}
+
+/**
+ *\brief                得到当前时间
+ *\return               时间(毫秒),只用于计算时间差
+ */
+static unsigned long thread_pool_now()
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (unsigned long)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+/**
+ *\brief                从随机选择的线程开始依次窃取任务
+ *\param[in]    pool    线程池
+ *\param[in]    worker  工作线程,不是线程池线程时为NULL,从第一个线程开始窃取
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      没有可窃取的任务
+ */
+static int thread_pool_steal(p_xt_thread_pool pool, p_xt_thread_pool_worker worker, p_xt_thread_pool_task *task)
+{
+    unsigned int count = pool->thread_max;
+    unsigned int begin = 0;
 
-    pthread_t tid;
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setscope(&attr, PTHREAD_SCOPE_PROCESS);            // 进程内竞争CPU
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);    // 退出时自行释放所占用的资源
+    if (NULL != worker)
+    {
+        worker->seed = worker->seed * 1103515245 + 12345;
+        begin = (worker->seed >> 16) % count;
+    }
 
     for (unsigned int i = 0; i < count; i++)
     {
-        ret = pthread_create(&tid, &attr, thread_pool_thread, pool);
+        p_xt_thread_pool_worker victim = &(pool->worker[(begin + i) % count]);
 
-        if (ret != 0)
+        if (victim != worker && 0 != ATOMIC_LOAD(&(victim->active)) && 0 == thread_pool_deque_steal(victim, task))
         {
-            E("create thread fail, E:%d", ret);
-            return -3;
+            return 0;
         }
+    }
 
-        pthread_detach(tid);    // 使线程处于分离状态,线程资源由系统回收
+    return -2;
+}
+
+/**
+ *\brief                从优先级队列取出任务,提升低优先级队列或按等待时间增加线程时记录取出时间
+ *\param[in]    pool    线程池
+ *\param[in]    priority 优先级
+ *\param[out]   task    任务
+ *\param[in,out] count  输入最大数量,输出取出的数量
+ *\return       0       成功\n
+ *              -2      队列为空
+ */
+static int thread_pool_pop(p_xt_thread_pool pool, int priority, p_xt_thread_pool_task *task, int *count)
+{
+    if (0 != list_head_pop_n(&(pool->task_queue[priority]), (void**)task, count))
+    {
+        return -2;
+    }
+
+    if (0 != pool->aging || 0 != pool->spawn_wait)
+    {
+        pool->task_time[priority] = thread_pool_now();
     }
 
-    D("ok");
     return 0;
 }
 
 /**
- *\brief                删除线程池任务
- *\param[in]    task    任务
- *\param[in]    param   自定义参数
- *\return       0
+ *\brief                得到应先执行的优先级:超过提升时间没有执行的低优先级队列,否则为非空的高优先级队列
+ *\param[in]    pool    线程池
+ *\return               优先级,没有需要先执行的队列时为-1
  */
-int thread_pool_del_task(p_xt_thread_pool_task task, void *param)
+static int thread_pool_urgent(p_xt_thread_pool pool)
+{
+    unsigned long now = 0;
+
+    if (0 != pool->aging)
+    {
+        for (int i = THREAD_POOL_PRIORITY_COUNT - 1; i > THREAD_POOL_PRIORITY_HIGH; i--)   // 等待最久的后台任务最先提升
+        {
+            if (list_count(&(pool->task_queue[i])) <= 0)
+            {
+                continue;
+            }
+
+            if (0 == now)
+            {
+                now = thread_pool_now();
+            }
+
+            if (now - pool->task_time[i] >= pool->aging)
+            {
+                return i;
+            }
+        }
+    }
+
+    return (list_count(&(pool->task_queue[THREAD_POOL_PRIORITY_HIGH])) > 0) ? THREAD_POOL_PRIORITY_HIGH : -1;
+}
+
+/**
+ *\brief                从普通优先级的共享队列取出一批任务,第一个返回,其余放入本线程双端队列供自己和其它线程执行
+ *\param[in]    worker  工作线程
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      共享队列为空
+ */
+static int thread_pool_inject(p_xt_thread_pool_worker worker, p_xt_thread_pool_task *task)
 {
-    free(task);
+    p_xt_thread_pool      pool  = worker->pool;
+    int                   count = list_count(&(pool->task_queue[THREAD_POOL_PRIORITY_NORMAL])) / (int)ATOMIC_LOAD(&(pool->thread_count)) + 1;
+    p_xt_thread_pool_task batch[THREAD_POOL_BATCH];
+
+    if (count > THREAD_POOL_BATCH)
+    {
+        count = THREAD_POOL_BATCH;
+    }
+
+    if (0 != thread_pool_pop(pool, THREAD_POOL_PRIORITY_NORMAL, batch, &count))
+    {
+        return -2;
+    }
+
+    for (int i = count - 1; i > 0; i--)     // 倒序放入,本线程按原顺序取出
+    {
+        if (0 != thread_pool_deque_push(worker, batch[i]))
+        {
+            list_tail_push(&(pool->task_queue[THREAD_POOL_PRIORITY_NORMAL]), batch[i]);
+        }
+    }
+
+    if (count > 1)
+    {
+        thread_pool_notify(pool, count - 1);
+    }
+
+    *task = batch[0];
     return 0;
 }
 
 /**
- *\brief                线程池反初始化
+ *\brief                取一个任务,先取高优先级和需要提升的队列,工作窃取时再依次从本线程双端队列、
+ *                      共享队列、其它线程双端队列取,最后按优先级从高到低取
  *\param[in]    pool    线程池
- *\return       0       成功
+ *\param[in]    worker  工作线程,不是线程池线程时为NULL
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      没有任务
  */
-int thread_pool_uninit(p_xt_thread_pool pool)
+static int thread_pool_get(p_xt_thread_pool pool, p_xt_thread_pool_worker worker, p_xt_thread_pool_task *task)
 {
-    if (NULL == pool)
+    int ret      = -2;
+    int count    = 1;
+    int priority = thread_pool_urgent(pool);
+
+    if (priority >= 0 && 0 == thread_pool_pop(pool, priority, task, &count))
     {
-        return -1;
+        ret = 0;
+    }
+    else if (pool->steal &&
+             ((NULL != worker && (0 == thread_pool_deque_pop(worker, task) || 0 == thread_pool_inject(worker, task))) ||
+              0 == thread_pool_steal(pool, worker, task)))
+    {
+        ret = 0;    // thread_pool_inject放入双端队列的任务仍在队列中,只释放取出的一个
+    }
+    else
+    {
+        for (priority = THREAD_POOL_PRIORITY_HIGH; priority < THREAD_POOL_PRIORITY_COUNT && 0 != ret; priority++)
+        {
+            count = 1;
+            ret   = thread_pool_pop(pool, priority, task, &count);
+        }
     }
 
-    pool->run = false;
-    list_proc(&(pool->task_queue), thread_pool_del_task, NULL);
-    return 0;
+    if (0 == ret)
+    {
+        thread_pool_release(pool, 1);
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                队列为空时自旋等待任务,自旋得到任务后次数加倍,否则减半
+ *\param[in]    worker  工作线程
+ *\param[in]    spin    本线程当前自旋次数
+ *\param[out]   task    任务
+ *\return       0       成功\n
+ *              -2      自旋期间没有任务
+ */
+static int thread_pool_spin(p_xt_thread_pool_worker worker, unsigned int *spin, p_xt_thread_pool_task *task)
+{
+    p_xt_thread_pool pool = worker->pool;
+
+    for (unsigned int i = 0; i < *spin && pool->run; i++)
+    {
+        if (0 == thread_pool_get(pool, worker, task))
+        {
+            *spin = (*spin * 2 < pool->spin_count) ? *spin * 2 : pool->spin_count;
+            return 0;
+        }
+
+        CPU_RELAX();
+    }
+
+    *spin = (*spin / 2 > THREAD_POOL_SPIN) ? *spin / 2 : ((pool->spin_count < THREAD_POOL_SPIN) ? pool->spin_count : THREAD_POOL_SPIN);
+    return -2;
 }
 
 /**
- *\brief                添加任务
+ *\brief                多于最少线程数量时减少一个线程
  *\param[in]    pool    线程池
- *\param[in]    proc    任务回调接口
- *\param[in]    param   任务回调接口参数
- *\return       0       成功
+ *\return       0       成功\n
+ *              -2      不能减少
  */
-int thread_pool_put(p_xt_thread_pool pool, XT_THREAD_POOL_TASK_CALLBACK proc, void *param)
+static int thread_pool_retire(p_xt_thread_pool pool)
 {
-    if (NULL == pool || NULL == proc || !(pool->run))
+    long count;
+
+    while ((count = ATOMIC_LOAD(&(pool->thread_count))) > (long)pool->thread_min)
     {
-        return -1;
+        if (ATOMIC_CAS(&(pool->thread_count), count, count - 1))
+        {
+            return 0;
+        }
+    }
+
+    return -2;
+}
+
+/**
+ *\brief                没有任务时休眠等待thread_pool_notify或thread_pool_uninit唤醒,多余线程空闲超时后退出
+ *\param[in]    worker  工作线程
+ *\param[out]   task    任务
+ *\param[out]   retire  线程是否因空闲超时退出
+ *\return       0       成功\n
+ *              -2      线程池已停止或线程退出
+ */
+static int thread_pool_park(p_xt_thread_pool_worker worker, p_xt_thread_pool_task *task, bool *retire)
+{
+    p_xt_thread_pool pool    = worker->pool;
+    bool             elastic = pool->thread_max > pool->thread_min && 0 != pool->keep_alive;
+    struct timespec  abstime;
+
+    *retire = false;
+
+    while (pool->run)
+    {
+        long signal = ATOMIC_LOAD(&(pool->signal));
+
+        ATOMIC_ADD(&(pool->idle), 1);
+        ATOMIC_FENCE();     // 先加休眠数再取任务,与thread_pool_notify配对,避免丢失唤醒
+
+        int ret = thread_pool_get(pool, worker, task);
+
+        if (0 != ret)
+        {
+            if (elastic)
+            {
+                thread_pool_abstime(&abstime, pool->keep_alive);
+            }
+
+            pthread_mutex_lock(&(pool->idle_mutex));
+
+            while (signal == pool->signal && pool->run)
+            {
+                if (!elastic)
+                {
+                    pthread_cond_wait(&(pool->idle_cond), &(pool->idle_mutex));
+                }
+                else if (ETIMEDOUT == pthread_cond_timedwait(&(pool->idle_cond), &(pool->idle_mutex), &abstime))
+                {
+                    // 等待期间没有唤醒说明没有新任务,退出前仍计入休眠数,之后添加的任务会唤醒其它线程
+                    *retire = (signal == pool->signal && 0 == thread_pool_retire(pool));
+                    break;
+                }
+            }
+
+            pthread_mutex_unlock(&(pool->idle_mutex));
+        }
+
+        ATOMIC_ADD(&(pool->idle), -1);
+
+        if (0 == ret)
+        {
+            return 0;
+        }
+
+        if (*retire)
+        {
+            return -2;
+        }
+    }
+
+    return -2;
+}
+
+/**
+ *\brief                等待未完成数变为0,有任务时执行任务,没有任务时休眠到有任务完成
+ *\param[in]    pool    线程池
+ *\param[in]    pending 未完成数
+ *\param[in]    timeout 超时时间(毫秒),0不等待,-1一直等待
+ *\return       0       成功\n
+ *              -2      超时或线程池已停止
+ */
+static int thread_pool_wait(p_xt_thread_pool pool, volatile long *pending, int timeout)
+{
+    int                   ret = 0;
+    p_xt_thread_pool_task task;
+    struct timespec       abstime;
+
+    if (timeout > 0)
+    {
+        thread_pool_abstime(&abstime, (unsigned int)timeout);
+    }
+
+    while (0 != ATOMIC_LOAD(pending))
+    {
+        if (!(pool->run) || -2 == ret)
+        {
+            return -2;
+        }
+
+        if (0 == thread_pool_get(pool, (p_xt_thread_pool_worker)pthread_getspecific(pool->key), &task))
+        {
+            thread_pool_run(pool, task);
+            continue;
+        }
+
+        if (0 == timeout)
+        {
+            return -2;
+        }
+
+        pthread_mutex_lock(&(pool->done_mutex));
+
+        long signal = pool->done_signal;
+
+        ATOMIC_ADD(&(pool->done_waiter), 1);
+        ATOMIC_FENCE();     // 先加等待数再读完成状态,与thread_pool_done配对,避免丢失唤醒
+
+        // 有任务完成时醒来,再看是否有可帮助执行的任务
+        while (0 != ATOMIC_LOAD(pending) && signal == pool->done_signal && pool->run)
+        {
+            if (timeout < 0)
+            {
+                pthread_cond_wait(&(pool->done_cond), &(pool->done_mutex));
+            }
+            else if (ETIMEDOUT == pthread_cond_timedwait(&(pool->done_cond), &(pool->done_mutex), &abstime))
+            {
+                ret = -2;
+                break;
+            }
+        }
+
+        ATOMIC_ADD(&(pool->done_waiter), -1);
+
+        pthread_mutex_unlock(&(pool->done_mutex));
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                thread_pool_submit添加的任务的回调,保存返回值
+ *\param[in]    param   任务结果
+ *\return               无
+ */
+static void thread_pool_future_proc(void *param)
+{
+    p_xt_thread_pool_future future = (p_xt_thread_pool_future)param;
+    p_xt_thread_pool        pool   = future->pool;
+
+    future->result = future->proc(future->param);
+
+    ATOMIC_STORE(&(future->pending), 0);    // 之后等待的线程可能释放future,不再访问
+    thread_pool_done(pool);
+}
+
+/**
+ *\brief                丢弃不再执行的任务,future的结果为NULL,任务组的未完成数减1,避免等待的线程一直等待
+ *\param[in]    pool    线程池
+ *\param[in]    task    任务
+ *\return               无
+ */
+static void thread_pool_discard(p_xt_thread_pool pool, p_xt_thread_pool_task task)
+{
+    xt_thread_pool_task data = *task;
+
+    memory_pool_put(&(pool->task_pool), task);
+
+    if (thread_pool_future_proc == data.proc)
+    {
+        p_xt_thread_pool_future future = (p_xt_thread_pool_future)data.param;
+
+        future->result = NULL;
+        ATOMIC_STORE(&(future->pending), 0);
+        thread_pool_done(pool);
+    }
+
+    if (NULL != data.group)
+    {
+        ATOMIC_ADD(&(data.group->count), -1);
+        thread_pool_done(pool);
+    }
+}
+
+/**
+ *\brief                线程池停止后等待未完成数变为0,没有执行的任务由thread_pool_uninit或退出的线程丢弃,
+ *                      线程池线程先丢弃本线程双端队列中的任务,这些任务不会再被别的线程取走
+ *\param[in]    pool    线程池
+ *\param[in]    worker  调用线程的工作线程数据,不是线程池线程时为NULL
+ *\param[in]    pending 未完成数
+ *\return               无
+ */
+static void thread_pool_settle(p_xt_thread_pool pool, p_xt_thread_pool_worker worker, volatile long *pending)
+{
+    p_xt_thread_pool_task task;
+
+    if (NULL != worker && pool->steal)
+    {
+        while (0 == thread_pool_deque_pop(worker, &task))
+        {
+            thread_pool_discard(pool, task);
+        }
+    }
+
+    pthread_mutex_lock(&(pool->done_mutex));
+
+    ATOMIC_ADD(&(pool->done_waiter), 1);
+    ATOMIC_FENCE();     // 先加等待数再读未完成数,与thread_pool_done配对,避免丢失唤醒
+
+    while (0 != ATOMIC_LOAD(pending))
+    {
+        pthread_cond_wait(&(pool->done_cond), &(pool->done_mutex));
+    }
+
+    ATOMIC_ADD(&(pool->done_waiter), -1);
+
+    pthread_mutex_unlock(&(pool->done_mutex));
+}
+
+/**
+ *\brief                最后退出的线程或thread_pool_uninit释放任务队列和工作线程数组,队列中剩余的任务不再执行
+ *\param[in]    pool    线程池
+ *\return               无
+ */
+static void thread_pool_free(p_xt_thread_pool pool)
+{
+    p_xt_thread_pool_task task;
+
+    for (unsigned int i = 0; i < pool->thread_max; i++)
+    {
+        p_xt_thread_pool_worker worker = &(pool->worker[i]);
+
+        if (NULL != worker->deque)
+        {
+            while (0 == thread_pool_deque_pop(worker, &task))
+            {
+                thread_pool_discard(pool, task);
+            }
+
+            free((void*)worker->deque);
+        }
+    }
+
+    for (int i = 0; i < THREAD_POOL_PRIORITY_COUNT; i++)
+    {
+        int count = 1;
+
+        // thread_pool_uninit清空队列后停止前添加的任务
+        while (0 == list_head_pop_n(&(pool->task_queue[i]), (void**)&task, &count))
+        {
+            thread_pool_discard(pool, task);
+            count = 1;
+        }
+
+        list_uninit(&(pool->task_queue[i]));
+    }
+
+    memory_pool_uninit(&(pool->task_pool));
+    pthread_key_delete(pool->key);
+    pthread_cond_destroy(&(pool->idle_cond));
+    pthread_mutex_destroy(&(pool->idle_mutex));
+    ALIGNED_FREE(pool->worker);
+    ATOMIC_STORE(&(pool->worker), NULL);    // 之后不再访问线程池,等待线程池停止的线程可释放线程池数据
+}
+
+/**
+ *\brief                设置当前线程的名称和绑定的CPU,失败时只记录日志,线程照常运行
+ *\param[in]    worker  工作线程
+ *\return               无
+ */
+static void thread_pool_bind(p_xt_thread_pool_worker worker)
+{
+    p_xt_thread_pool pool  = worker->pool;
+    unsigned int     index = (unsigned int)(worker - pool->worker);
+    unsigned int     begin = 0;
+    unsigned int     end   = pool->cpu_count;
+    char             name[THREAD_POOL_THREAD_NAME];
+
+    if ('\0' != pool->name[0])
+    {
+        snprintf(name, sizeof(name), "%s-%u", pool->name, index);     // 序号过大时截断,不超过线程名称的长度限制
+#ifdef _WINDOWS
+        wchar_t wname[sizeof(name)];
+        MultiByteToWideChar(CP_UTF8, 0, name, -1, wname, sizeof(name));
+
+        if (FAILED(SetThreadDescription(GetCurrentThread(), wname)))
+        {
+            W("set thread name fail, worker:%u name:%s", index, name);
+        }
+#else
+        int ret = pthread_setname_np(pthread_self(), name);
+
+        if (0 != ret)
+        {
+            W("set thread name fail, worker:%u name:%s E:%d", index, name, ret);
+        }
+#endif
+    }
+
+    if (NULL == pool->cpu)
+    {
+        return;
+    }
+
+    if (pool->cpu_each)
+    {
+        begin = index % pool->cpu_count;
+        end   = begin + 1;
+    }
+
+#ifdef _WINDOWS
+    DWORD_PTR mask = 0;
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        mask |= (DWORD_PTR)1 << pool->cpu[i];
+    }
+
+    if (0 == SetThreadAffinityMask(GetCurrentThread(), mask))
+    {
+        E("set affinity fail, worker:%u E:%u", index, (unsigned int)GetLastError());
+    }
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        CPU_SET(pool->cpu[i], &set);
+    }
+
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    if (0 != ret)
+    {
+        E("set affinity fail, worker:%u E:%d", index, ret);
+    }
+#endif
+}
+
+/**
+ *\brief                线程池线程
+ *\param[in]    worker  工作线程
+ *\return               空
+ */
+void* thread_pool_thread(p_xt_thread_pool_worker worker)
+{
+    D("begin");
+
+    int count;
+    int priority;
+    bool retire = false;
+    p_xt_thread_pool pool = worker->pool;
+    unsigned int spin = pool->spin_count;
+    p_xt_thread_pool_task task[THREAD_POOL_BATCH];
+
+    pthread_setspecific(pool->key, worker);
+    thread_pool_bind(worker);
+
+    while(pool->run && !retire)
+    {
+        count    = 0;
+        priority = thread_pool_urgent(pool);
+
+        if (priority < 0)
+        {
+            priority = THREAD_POOL_PRIORITY_NORMAL;
+        }
+
+        // 不窃取时成批取任务,按线程数平分队列中的任务,避免一个线程取走全部任务而其它线程空闲,
+        // 后台任务耗时长,成批取会使高优先级任务等待,每次只取一个
+        if (!(pool->steal) && THREAD_POOL_PRIORITY_LOW != priority)
+        {
+            count = list_count(&(pool->task_queue[priority])) / (int)ATOMIC_LOAD(&(pool->thread_count)) + 1;
+
+            if (count > THREAD_POOL_BATCH)
+            {
+                count = THREAD_POOL_BATCH;
+            }
+
+            if (0 != thread_pool_pop(pool, priority, task, &count))
+            {
+                count = 0;
+            }
+            else
+            {
+                thread_pool_release(pool, count);
+            }
+        }
+
+        if (0 == count)
+        {
+            count = 1;
+
+            // 没有任务时先自旋,仍没有任务时休眠等待thread_pool_put或thread_pool_uninit唤醒
+            if (0 != thread_pool_get(pool, worker, task) &&
+                (0 == spin || 0 != thread_pool_spin(worker, &spin, task)) &&
+                0 != thread_pool_park(worker, task, &retire))
+            {
+                continue;
+            }
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            thread_pool_run(pool, task[i]);
+        }
+    }
+
+    // 退出后其它线程不再窃取本线程双端队列中的任务,空闲退出时执行完,停止时丢弃
+    while (pool->steal && 0 == thread_pool_deque_pop(worker, task))
+    {
+        if (pool->run)
+        {
+            thread_pool_run(pool, task[0]);
+        }
+        else
+        {
+            thread_pool_discard(pool, task[0]);
+        }
+    }
+
+    ATOMIC_STORE(&(worker->active), 0);     // 之后不再访问worker,可被新线程使用
+
+    memory_pool_magazine_release(&(pool->task_pool));   // 线程缓存在线程退出时才释放,最后退出的线程可能已反初始化任务内存池
+
+    if (0 == ATOMIC_ADD(&(pool->alive), -1))
+    {
+        thread_pool_free(pool);
+    }
+
+    D("exit");
+    return NULL;
+}
+
+/**
+ *\brief                增加一个线程,使用空闲的工作线程数据
+ *\param[in]    pool    线程池
+ *\return       0       成功\n
+ *              -2      已达到最多线程数量\n
+ *              -3      创建线程失败
+ */
+static int thread_pool_spawn(p_xt_thread_pool pool)
+{
+    long count = ATOMIC_LOAD(&(pool->thread_count));
+
+    if (count >= (long)pool->thread_max || !ATOMIC_CAS(&(pool->thread_count), count, count + 1))
+    {
+        return -2;
+    }
+
+    for (unsigned int i = 0; i < pool->thread_max; i++)
+    {
+        p_xt_thread_pool_worker worker = &(pool->worker[i]);
+
+        if (0 != ATOMIC_LOAD(&(worker->active)) || !ATOMIC_CAS(&(worker->active), 0, 1))
+        {
+            continue;
+        }
+
+        pthread_t tid;
+        pthread_attr_t thread_attr;
+        pthread_attr_init(&thread_attr);
+        pthread_attr_setscope(&thread_attr, PTHREAD_SCOPE_PROCESS);     // 进程内竞争CPU
+        pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);    // 退出时自行释放所占用的资源
+
+        ATOMIC_ADD(&(pool->alive), 1);
+
+        int ret = pthread_create(&tid, &thread_attr, thread_pool_thread, worker);
+
+        pthread_attr_destroy(&thread_attr);
+
+        if (ret != 0)
+        {
+            ATOMIC_ADD(&(pool->alive), -1);
+            ATOMIC_STORE(&(worker->active), 0);
+            ATOMIC_ADD(&(pool->thread_count), -1);
+            E("create thread fail, E:%d", ret);
+            return -3;
+        }
+
+        pthread_detach(tid);    // 使线程处于分离状态,线程资源由系统回收
+        return 0;
+    }
+
+    ATOMIC_ADD(&(pool->thread_count), -1);  // 退出的线程还没有释放工作线程数据
+    return -2;
+}
+
+/**
+ *\brief                所有线程都忙且队列中任务多或长时间没有取出时增加线程
+ *\param[in]    pool    线程池
+ *\param[in]    worker  添加任务的工作线程,其双端队列中的任务计入普通优先级,为NULL时只看队列
+ *\return               无
+ */
+static void thread_pool_grow(p_xt_thread_pool pool, p_xt_thread_pool_worker worker)
+{
+    long count = ATOMIC_LOAD(&(pool->thread_count));
+
+    if (count >= (long)pool->thread_max || ATOMIC_LOAD(&(pool->idle)) > 0 || ATOMIC_LOAD(&(pool->process_count)) < count)
+    {
+        return;
+    }
+
+    for (int priority = THREAD_POOL_PRIORITY_HIGH; priority < THREAD_POOL_PRIORITY_COUNT; priority++)
+    {
+        int depth = list_count(&(pool->task_queue[priority]));
+
+        if (THREAD_POOL_PRIORITY_NORMAL == priority && NULL != worker)
+        {
+            depth += (int)(ATOMIC_LOAD(&(worker->bottom)) - ATOMIC_LOAD(&(worker->top)));
+        }
+
+        if ((0 != pool->spawn_depth && depth >= (int)pool->spawn_depth) ||
+            (0 != pool->spawn_wait && depth > 0 && thread_pool_now() - pool->task_time[priority] >= pool->spawn_wait))
+        {
+            thread_pool_spawn(pool);
+            return;
+        }
+    }
+}
+
+/**
+ *\brief                线程池属性初始化为默认值,线程数量为CPU数量,不增减线程,不自旋,不使用工作窃取
+ *\param[in]    attr    线程池属性
+ *\return       0       成功
+ */
+int thread_pool_attr_init(p_xt_thread_pool_attr attr)
+{
+    if (NULL == attr)
+    {
+        return -1;
+    }
+
+#ifdef _WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    attr->thread_count = info.dwNumberOfProcessors;
+#else
+    long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    attr->thread_count = (cpu > 0) ? (unsigned int)cpu : 1;
+#endif
+
+    attr->thread_max    = 0;
+    attr->keep_alive    = THREAD_POOL_KEEP;
+    attr->spawn_depth   = THREAD_POOL_DEPTH;
+    attr->spawn_wait    = THREAD_POOL_WAIT;
+    attr->spin_count    = 0;
+    attr->steal         = false;
+    attr->deque_size    = THREAD_POOL_DEQUE;
+    attr->aging         = THREAD_POOL_AGING;
+    attr->name          = NULL;
+    attr->cpu           = NULL;
+    attr->cpu_count     = 0;
+    attr->cpu_each      = false;
+    attr->capacity      = 0;
+    attr->overflow      = THREAD_POOL_OVERFLOW_BLOCK;
+    attr->block_timeout = -1;
+    return 0;
+}
+
+/**
+ *\brief                反初始化前几个优先级的任务队列,用于初始化失败时
+ *\param[in]    pool    线程池
+ *\param[in]    count   已初始化的队列数量
+ *\return               无
+ */
+static void thread_pool_queue_uninit(p_xt_thread_pool pool, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        list_uninit(&(pool->task_queue[i]));
+    }
+}
+
+/**
+ *\brief                线程池初始化
+ *\param[in]    pool    线程池
+ *\attention    pool    需要转递到线线程中,不要释放此内存,否则会野指针
+ *\param[in]    count   线程数量
+ *\return       0       成功
+ */
+int thread_pool_init(p_xt_thread_pool pool, unsigned int count)
+{
+    xt_thread_pool_attr attr;
+
+    thread_pool_attr_init(&attr);
+    attr.thread_count = count;
+
+    return thread_pool_init_ex(pool, &attr);
+}
+
+/**
+ *\brief                按属性初始化线程池
+ *\param[in]    pool    线程池
+ *\attention    pool    需要转递到线线程中,不要释放此内存,否则会野指针
+ *\param[in]    attr    线程池属性
+ *\return       0       成功
+ */
+int thread_pool_init_ex(p_xt_thread_pool pool, p_xt_thread_pool_attr attr)
+{
+    if (NULL == pool || NULL == attr || 0 == attr->thread_count || (NULL != attr->cpu && 0 == attr->cpu_count) ||
+        attr->overflow < THREAD_POOL_OVERFLOW_BLOCK || attr->overflow > THREAD_POOL_OVERFLOW_CALLER_RUNS)
+    {
+        return -1;
+    }
+
+    for (unsigned int i = 0; NULL != attr->cpu && i < attr->cpu_count; i++)
+    {
+        if (attr->cpu[i] >= THREAD_POOL_CPU_MAX)
+        {
+            E("cpu out of range, cpu:%u", attr->cpu[i]);
+            return -1;
+        }
+    }
+
+    unsigned int  count = (attr->thread_max > attr->thread_count) ? attr->thread_max : attr->thread_count;
+    unsigned long size  = THREAD_POOL_BATCH;
+
+    while (size < attr->deque_size)
+    {
+        size <<= 1;
+    }
+
+    int ret = 0;
+    int priority;
+
+    for (priority = 0; priority < THREAD_POOL_PRIORITY_COUNT && 0 == ret; priority++)
+    {
+        ret = list_init(&(pool->task_queue[priority]));
+        pool->task_time[priority] = 0;
+    }
+
+    if (0 != ret)
+    {
+        thread_pool_queue_uninit(pool, priority - 1);
+        return -2;
+    }
+
+    if (0 != memory_pool_init_ex(&(pool->task_pool), sizeof(xt_thread_pool_task), THREAD_POOL_TASK, MEMORY_POOL_MAGAZINE))
+    {
+        E("init task pool fail");
+        thread_pool_queue_uninit(pool, THREAD_POOL_PRIORITY_COUNT);
+        return -3;
+    }
+
+    unsigned int cpu_count = (NULL == attr->cpu) ? 0 : attr->cpu_count;
+
+    if (NULL == ALIGNED_MALLOC(pool->worker, CACHE_LINE_SIZE, sizeof(xt_thread_pool_worker) * count + sizeof(unsigned int) * cpu_count))
+    {
+        E("malloc worker fail, count:%u", count);
+        memory_pool_uninit(&(pool->task_pool));
+        thread_pool_queue_uninit(pool, THREAD_POOL_PRIORITY_COUNT);
+        return -3;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        p_xt_thread_pool_worker worker = &(pool->worker[i]);
+
+        worker->pool   = pool;
+        worker->deque  = NULL;
+        worker->mask   = size - 1;
+        worker->seed   = i + 1;
+        worker->active = 0;
+        worker->bottom = 0;
+        worker->top    = 0;
+
+        if (attr->steal && NULL == (worker->deque = (p_xt_thread_pool_task volatile*)malloc(sizeof(p_xt_thread_pool_task) * size)))
+        {
+            E("malloc deque fail, size:%lu", size);
+
+            while (i-- > 0)
+            {
+                free((void*)pool->worker[i].deque);
+            }
+
+            ALIGNED_FREE(pool->worker);
+            memory_pool_uninit(&(pool->task_pool));
+            thread_pool_queue_uninit(pool, THREAD_POOL_PRIORITY_COUNT);
+            return -3;
+        }
+    }
+
+    pool->cpu       = (0 == cpu_count) ? NULL : (unsigned int*)(pool->worker + count);    // 线程退出后还可能创建新线程,复制一份
+    pool->cpu_count = cpu_count;
+    pool->cpu_each  = attr->cpu_each;
+    pool->name[0]   = '\0';
+
+    if (cpu_count > 0)
+    {
+        memcpy(pool->cpu, attr->cpu, sizeof(unsigned int) * cpu_count);
+    }
+
+    if (NULL != attr->name)
+    {
+        strncpy(pool->name, attr->name, THREAD_POOL_NAME_SIZE - 1);
+        pool->name[THREAD_POOL_NAME_SIZE - 1] = '\0';
+    }
+
+    pthread_key_create(&(pool->key), NULL);
+    pthread_mutex_init(&(pool->idle_mutex), NULL);
+    pthread_cond_init(&(pool->idle_cond), NULL);
+    pthread_mutex_init(&(pool->done_mutex), NULL);  // 线程池停止后其它线程可能还在等待,不销毁
+    pthread_cond_init(&(pool->done_cond), NULL);
+    pthread_mutex_init(&(pool->full_mutex), NULL);  // 同上
+    pthread_cond_init(&(pool->full_cond), NULL);
+
+    pool->run           = true;
+    pool->thread_count  = 0;
+    pool->thread_min    = attr->thread_count;
+    pool->thread_max    = count;
+    pool->keep_alive    = attr->keep_alive;
+    pool->spawn_depth   = attr->spawn_depth;
+    pool->spawn_wait    = attr->spawn_wait;
+    pool->spin_count    = attr->spin_count;
+    pool->steal         = attr->steal;
+    pool->aging         = attr->aging;
+    pool->process_count = 0;
+    pool->alive         = 0;
+    pool->idle          = 0;
+    pool->signal        = 0;
+    pool->done_waiter   = 0;
+    pool->done_signal   = 0;
+    pool->capacity      = attr->capacity;
+    pool->overflow      = attr->overflow;
+    pool->block_timeout = attr->block_timeout;
+    pool->queued        = 0;
+    pool->full_waiter   = 0;
+
+    for (unsigned int i = 0; i < pool->thread_min; i++)
+    {
+        if (0 != thread_pool_spawn(pool))
+        {
+            return -3;
+        }
+    }
+
+    D("ok");
+    return 0;
+}
+
+/**
+ *\brief                删除线程池任务,不再执行
+ *\param[in]    task    任务
+ *\param[in]    param   线程池
+ *\return       0
+ */
+int thread_pool_del_task(p_xt_thread_pool_task task, void *param)
+{
+    thread_pool_discard((p_xt_thread_pool)param, task);
+    return 0;
+}
+
+/**
+ *\brief                在队列中预留添加任务的空位
+ *\param[in]    pool    线程池
+ *\param[in]    count   需要的空位数量
+ *\return               得到的空位数量,队列满时为0
+ */
+static int thread_pool_reserve(p_xt_thread_pool pool, int count)
+{
+    while (true)
+    {
+        long queued = ATOMIC_LOAD(&(pool->queued));
+        long space  = (long)pool->capacity - queued;
+
+        if (space <= 0)
+        {
+            return 0;
+        }
+
+        if (space > count)
+        {
+            space = count;
+        }
+
+        if (ATOMIC_CAS(&(pool->queued), queued, queued + space))
+        {
+            return (int)space;
+        }
+    }
+}
+
+/**
+ *\brief                队列满时等待空位
+ *\param[in]    pool    线程池
+ *\param[in]    abstime 等待的截止时间,一次添加多次等待时共用,block_timeout不大于0时不使用
+ *\return       0       有空位\n
+ *              -2      超时或线程池已停止
+ */
+static int thread_pool_block(p_xt_thread_pool pool, const struct timespec *abstime)
+{
+    int ret = 0;
+
+    ATOMIC_ADD(&(pool->full_waiter), 1);
+    ATOMIC_FENCE();
+
+    pthread_mutex_lock(&(pool->full_mutex));
+
+    while (pool->run && ATOMIC_LOAD(&(pool->queued)) >= (long)pool->capacity && 0 == ret)
+    {
+        if (pool->block_timeout < 0)
+        {
+            pthread_cond_wait(&(pool->full_cond), &(pool->full_mutex));
+        }
+        else if (0 == pool->block_timeout)
+        {
+            ret = ETIMEDOUT;
+        }
+        else
+        {
+            ret = pthread_cond_timedwait(&(pool->full_cond), &(pool->full_mutex), abstime);
+        }
+    }
+
+    pthread_mutex_unlock(&(pool->full_mutex));
+
+    ATOMIC_ADD(&(pool->full_waiter), -1);
+
+    // 超时的同时可能刚有空位,再看一次,避免有空位却返回超时
+    if (ETIMEDOUT == ret && ATOMIC_LOAD(&(pool->queued)) < (long)pool->capacity)
+    {
+        ret = 0;
+    }
+
+    return (pool->run && 0 == ret) ? 0 : -2;
+}
+
+/**
+ *\brief                丢弃队列中最早的任务,先丢弃低优先级的,丢弃的任务不执行,所属任务组计为完成,任务结果为NULL
+ *\param[in]    pool    线程池
+ *\return       0       成功\n
+ *              -2      没有可丢弃的任务
+ */
+static int thread_pool_drop(p_xt_thread_pool pool)
+{
+    int                   count;
+    p_xt_thread_pool_task task = NULL;
+
+    for (int priority = THREAD_POOL_PRIORITY_COUNT - 1; priority >= THREAD_POOL_PRIORITY_HIGH && NULL == task; priority--)
+    {
+        count = 1;
+
+        if (0 != list_head_pop_n(&(pool->task_queue[priority]), (void**)&task, &count))
+        {
+            task = NULL;
+        }
+    }
+
+    if (NULL == task && (!(pool->steal) || 0 != thread_pool_steal(pool, NULL, &task)))
+    {
+        return -2;
+    }
+
+    thread_pool_release(pool, 1);
+    thread_pool_discard(pool, task);
+
+    D("drop task");
+    return 0;
+}
+
+/**
+ *\brief                队列满时按线程池的处理方式处理要添加的任务
+ *\param[in]    pool    线程池
+ *\param[in]    data    要添加的任务
+ *\param[in]    abstime 等待空位的截止时间
+ *\param[out]   done    任务是否已在本线程执行
+ *\return       0       已执行或可重新预留空位\n
+ *              -2      拒绝或等待超时
+ */
+static int thread_pool_overflow(p_xt_thread_pool pool, p_xt_thread_pool_task data, const struct timespec *abstime, bool *done)
+{
+    *done = false;
+
+    switch (pool->overflow)
+    {
+        case THREAD_POOL_OVERFLOW_BLOCK:
+            if (NULL == pthread_getspecific(pool->key))
+            {
+                return thread_pool_block(pool, abstime);
+            }
+            break;      // 线程池线程等待时可能所有线程都在等待,直接执行
+
+        case THREAD_POOL_OVERFLOW_DROP_OLDEST:
+            return thread_pool_drop(pool);
+
+        case THREAD_POOL_OVERFLOW_CALLER_RUNS:
+            break;
+
+        default:
+            return -2;
+    }
+
+    thread_pool_exec(pool, data);
+    *done = true;
+    return 0;
+}
+
+/**
+ *\brief                线程池反初始化
+ *\param[in]    pool    线程池
+ *\return       0       成功
+ */
+int thread_pool_uninit(p_xt_thread_pool pool)
+{
+    if (NULL == pool)
+    {
+        return -1;
+    }
+
+    ATOMIC_ADD(&(pool->alive), 1);  // 清空队列期间不让最后退出的线程释放队列
+
+    pool->run = false;
+
+    pthread_mutex_lock(&(pool->idle_mutex));
+    pool->signal++;
+    pthread_cond_broadcast(&(pool->idle_cond));
+    pthread_mutex_unlock(&(pool->idle_mutex));
+
+    pthread_mutex_lock(&(pool->done_mutex));
+    pool->done_signal++;
+    pthread_cond_broadcast(&(pool->done_cond));
+    pthread_mutex_unlock(&(pool->done_mutex));
+
+    pthread_mutex_lock(&(pool->full_mutex));
+    pthread_cond_broadcast(&(pool->full_cond));
+    pthread_mutex_unlock(&(pool->full_mutex));
+
+    for (int i = 0; i < THREAD_POOL_PRIORITY_COUNT; i++)
+    {
+        list_drain(&(pool->task_queue[i]), thread_pool_del_task, pool);
+    }
+
+    if (0 == ATOMIC_ADD(&(pool->alive), -1))
+    {
+        thread_pool_free(pool);
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                添加任务,任务从任务内存池得到,工作窃取时线程池线程添加的普通优先级任务放入本线程的双端队列
+ *\param[in]    pool    线程池
+ *\param[in]    priority 优先级
+ *\param[in]    data    任务数组
+ *\param[in,out] count  输入任务数量,输出添加的数量
+ *\param[in]    group   所属任务组,可以为NULL
+ *\return       0       成功\n
+ *              -3      得到任务内存失败
+ */
+static int thread_pool_push(p_xt_thread_pool pool, int priority, p_xt_thread_pool_task data, int *count, p_xt_thread_pool_group group)
+{
+    int                     n;
+    int                     push;
+    int                     space;
+    bool                    done;
+    int                     ret    = 0;
+    int                     total  = 0;
+    bool                    timed  = false;
+    struct timespec         abstime;
+    p_xt_list               queue  = &(pool->task_queue[priority]);
+    p_xt_thread_pool_task   task[THREAD_POOL_BATCH];
+    p_xt_thread_pool_worker worker = NULL;
+
+    if (pool->steal && THREAD_POOL_PRIORITY_NORMAL == priority)
+    {
+        worker = (p_xt_thread_pool_worker)pthread_getspecific(pool->key);
+    }
+
+    while (total < *count && 0 == ret)
+    {
+        space = (*count - total < THREAD_POOL_BATCH) ? *count - total : THREAD_POOL_BATCH;
+
+        if (0 != pool->capacity && 0 == (space = thread_pool_reserve(pool, space)))
+        {
+            xt_thread_pool_task overflow = data[total];
+            overflow.group = group;
+
+            // 截止时间在第一次等待时计算,一次添加多次等待的总时间不超过block_timeout
+            if (!timed && THREAD_POOL_OVERFLOW_BLOCK == pool->overflow && pool->block_timeout > 0)
+            {
+                thread_pool_abstime(&abstime, (unsigned int)pool->block_timeout);
+                timed = true;
+            }
+
+            if (0 == (ret = thread_pool_overflow(pool, &overflow, &abstime, &done)) && done)
+            {
+                total++;
+            }
+
+            continue;
+        }
+
+        for (n = 0; n < space; n++)
+        {
+            if (0 != memory_pool_get(&(pool->task_pool), (void**)&(task[n])))
+            {
+                E("get task fail");
+                ret = -3;
+                break;
+            }
+
+            *(task[n])      = data[total + n];
+            task[n]->group  = group;
+        }
+
+        if (0 != pool->capacity && n < space)
+        {
+            ATOMIC_ADD(&(pool->queued), n - space);     // 归还没有使用的空位
+        }
+
+        // 线程池线程添加的任务放入本线程双端队列,满时或外部线程添加的任务放入共享队列
+        for (int i = push = 0; i < n; i++)
+        {
+            if (NULL == worker || 0 != thread_pool_deque_push(worker, task[i]))
+            {
+                task[push++] = task[i];
+            }
+        }
+
+        if (push > 0)
+        {
+            // 队列由空变为非空时开始计算等待时间,避免长时间没有任务的低优先级队列刚有任务就被提升或增加线程
+            if ((0 != pool->aging || 0 != pool->spawn_wait) && list_count(queue) <= 0)
+            {
+                pool->task_time[priority] = thread_pool_now();
+            }
+
+            int pushed = push;
+
+            if (0 != list_tail_push_n(queue, (void**)task, &pushed))
+            {
+                E("push task fail, count:%d", push - pushed);     // 链表分配块失败,没有放入的任务不执行
+
+                for (int i = pushed; i < push; i++)
+                {
+                    memory_pool_put(&(pool->task_pool), task[i]);
+                }
+
+                if (0 != pool->capacity)
+                {
+                    ATOMIC_ADD(&(pool->queued), pushed - push);
+                }
+
+                n  -= push - pushed;
+                ret = -3;
+            }
+        }
+
+        if (n > 0)
+        {
+            total += n;
+            thread_pool_notify(pool, n);
+
+            if ((long)pool->thread_max > ATOMIC_LOAD(&(pool->thread_count)))
+            {
+                thread_pool_grow(pool, worker);
+            }
+        }
+    }
+
+    *count = total;
+    return ret;
+}
+
+/**
+ *\brief                添加普通优先级的任务,工作窃取时线程池线程添加的任务放入本线程的双端队列
+ *\param[in]    pool    线程池
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_put(p_xt_thread_pool pool, XT_THREAD_POOL_TASK_CALLBACK proc, void *param)
+{
+    return thread_pool_put_priority(pool, THREAD_POOL_PRIORITY_NORMAL, proc, param);
+}
+
+/**
+ *\brief                添加多个普通优先级的任务,每批任务只加一次锁
+ *\param[in]    pool    线程池
+ *\param[in]    task    任务数组,只使用proc和param
+ *\param[in,out] count  输入任务数量,输出添加的数量
+ *\return       0       成功\n
+ *              -2      队列已满,count为已添加的数量\n
+ *              -3      得到任务内存失败
+ */
+int thread_pool_put_n(p_xt_thread_pool pool, p_xt_thread_pool_task task, int *count)
+{
+    if (NULL == pool || NULL == task || NULL == count || *count < 0 || !(pool->run))
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < *count; i++)
+    {
+        if (NULL == task[i].proc)
+        {
+            return -1;
+        }
+    }
+
+    return thread_pool_push(pool, THREAD_POOL_PRIORITY_NORMAL, task, count, NULL);
+}
+
+/**
+ *\brief                按优先级添加任务
+ *\param[in]    pool    线程池
+ *\param[in]    priority 优先级,THREAD_POOL_PRIORITY_HIGH等
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_put_priority(p_xt_thread_pool pool, int priority, XT_THREAD_POOL_TASK_CALLBACK proc, void *param)
+{
+    if (NULL == pool || NULL == proc || !(pool->run) || priority < 0 || priority >= THREAD_POOL_PRIORITY_COUNT)
+    {
+        return -1;
+    }
+
+    int                 count = 1;
+    xt_thread_pool_task task  = { proc, param, NULL };
+
+    return thread_pool_push(pool, priority, &task, &count, NULL);
+}
+
+/**
+ *\brief                添加有返回值的任务
+ *\param[in]    pool    线程池
+ *\param[out]   future  任务结果,任务完成前不要释放此内存
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_submit(p_xt_thread_pool pool, p_xt_thread_pool_future future, XT_THREAD_POOL_FUTURE_CALLBACK proc, void *param)
+{
+    if (NULL == pool || NULL == future || NULL == proc || !(pool->run))
+    {
+        return -1;
+    }
+
+    future->pool    = pool;
+    future->proc    = proc;
+    future->param   = param;
+    future->result  = NULL;
+    future->pending = 1;
+
+    int                 count = 1;
+    xt_thread_pool_task task  = { thread_pool_future_proc, future, NULL };
+
+    int ret = thread_pool_push(pool, THREAD_POOL_PRIORITY_NORMAL, &task, &count, NULL);
+
+    if (0 != ret)
+    {
+        future->pending = 0;
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                得到任务结果,不等待
+ *\param[in]    future  任务结果
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      任务未完成
+ */
+int thread_pool_future_get(p_xt_thread_pool_future future, void **result)
+{
+    return thread_pool_future_wait_for(future, 0, result);
+}
+
+/**
+ *\brief                等待任务完成,等待时执行线程池中的其它任务
+ *\param[in]    future  任务结果
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      线程池已停止
+ */
+int thread_pool_future_wait(p_xt_thread_pool_future future, void **result)
+{
+    return thread_pool_future_wait_for(future, -1, result);
+}
+
+/**
+ *\brief                限时等待任务完成,等待时执行线程池中的其它任务,执行的任务耗时长时可能超时
+ *\param[in]    future  任务结果
+ *\param[in]    timeout 超时时间(毫秒),0不等待,-1一直等待
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      超时或线程池已停止
+ */
+int thread_pool_future_wait_for(p_xt_thread_pool_future future, int timeout, void **result)
+{
+    if (NULL == future || NULL == future->pool)
+    {
+        return -1;
+    }
+
+    if (0 == timeout)
+    {
+        if (0 != ATOMIC_LOAD(&(future->pending)))
+        {
+            return -2;
+        }
+    }
+    else if (0 != thread_pool_wait(future->pool, &(future->pending), timeout))
+    {
+        return -2;
+    }
+
+    if (NULL != result)
+    {
+        *result = future->result;
+    }
+
+    return 0;
+}
+
+/**
+ *\brief                初始化任务组
+ *\param[in]    group   任务组
+ *\param[in]    pool    线程池
+ *\return       0       成功
+ */
+int thread_pool_group_init(p_xt_thread_pool_group group, p_xt_thread_pool pool)
+{
+    if (NULL == group || NULL == pool)
+    {
+        return -1;
+    }
+
+    group->pool  = pool;
+    group->count = 0;
+    return 0;
+}
+
+/**
+ *\brief                向任务组添加任务
+ *\param[in]    group   任务组
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_group_put(p_xt_thread_pool_group group, XT_THREAD_POOL_TASK_CALLBACK proc, void *param)
+{
+    if (NULL == group || NULL == group->pool || NULL == proc || !(group->pool->run))
+    {
+        return -1;
+    }
+
+    ATOMIC_ADD(&(group->count), 1);
+
+    int                 count = 1;
+    xt_thread_pool_task task  = { proc, param, group };
+
+    int ret = thread_pool_push(group->pool, THREAD_POOL_PRIORITY_NORMAL, &task, &count, group);
+
+    if (0 != ret)
+    {
+        ATOMIC_ADD(&(group->count), -1);
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                等待任务组的任务全部完成,等待时执行线程池中的任务而不是阻塞
+ *\param[in]    group   任务组
+ *\return       0       成功\n
+ *              -2      线程池已停止
+ */
+int thread_pool_group_wait_all(p_xt_thread_pool_group group)
+{
+    if (NULL == group || NULL == group->pool)
+    {
+        return -1;
+    }
+
+    return thread_pool_wait(group->pool, &(group->count), -1);
+}
+
+/**
+ *\brief                并行循环或归约的一个参与线程,不断取出下一段执行,直到全部取完
+ *\param[in]    param   并行循环数据
+ *\return               无
+ */
+static void thread_pool_loop_proc(void *param)
+{
+    p_xt_thread_pool_loop loop  = (p_xt_thread_pool_loop)param;
+    char                 *value = NULL;
+
+    if (NULL != loop->map)
+    {
+        value = loop->value + (size_t)(ATOMIC_ADD(&(loop->slot), 1) - 1) * loop->size;
+    }
+
+    while (true)
+    {
+        unsigned __int64 begin = ATOMIC_LOAD64(&(loop->next));
+
+        if (begin >= loop->end)
+        {
+            break;
+        }
+
+        // 每次取剩余的1/(2*参与线程数),开始时段长减少取段的竞争,快结束时段短使各线程同时完成
+        unsigned __int64 step = (loop->end - begin) / (loop->ways * 2);
+
+        if (step < loop->grain)
+        {
+            step = (loop->grain < loop->end - begin) ? loop->grain : loop->end - begin;
+        }
+
+        if (!ATOMIC_CAS64(&(loop->next), begin, begin + step))
+        {
+            continue;
+        }
+
+        if (NULL == loop->map)
+        {
+            loop->proc((size_t)begin, (size_t)(begin + step), loop->ctx);
+        }
+        else
+        {
+            loop->map((size_t)begin, (size_t)(begin + step), loop->ctx, value);
+        }
+    }
+}
+
+/**
+ *\brief                执行并行循环或归约,调用线程也参与执行,全部完成后返回
+ *\param[in]    pool    线程池
+ *\param[in]    loop    并行循环数据,已设置回调接口,返回时value已分配
+ *\param[in]    begin   开始位置
+ *\param[in]    end     结束位置,不含
+ *\param[in]    grain   每段的最小长度,0为自动计算
+ *\param[in]    init    归约初值,并行循环时为NULL
+ *\return       0       成功\n
+ *              -2      线程池已停止,各段仍已执行完,返回时没有线程再访问loop\n
+ *              -3      分配内存失败
+ */
+static int thread_pool_loop_run(p_xt_thread_pool pool, p_xt_thread_pool_loop loop, size_t begin, size_t end, size_t grain, const void *init)
+{
+    unsigned __int64        count  = end - begin;
+    unsigned int            ways   = (unsigned int)ATOMIC_LOAD(&(pool->thread_count)) + 1;
+    p_xt_thread_pool_worker worker = (p_xt_thread_pool_worker)pthread_getspecific(pool->key);
+
+    if (ways > count)
+    {
+        ways = (unsigned int)count;
+    }
+
+    if (0 == grain)
+    {
+        grain = (size_t)(count / ((unsigned __int64)ways * THREAD_POOL_LOOP_SPLIT));
+    }
+
+    loop->next  = begin;
+    loop->end   = end;
+    loop->grain = (0 == grain) ? 1 : grain;
+    loop->ways  = ways;
+    loop->slot  = 0;
+    loop->value = NULL;
+
+    if (NULL != init)
+    {
+        if (NULL == (loop->value = (char*)malloc(loop->size * ways)))
+        {
+            E("malloc reduce value fail, count:%u", ways);
+            return -3;
+        }
+
+        for (unsigned int i = 0; i < ways; i++)
+        {
+            memcpy(loop->value + loop->size * i, init, loop->size);
+        }
+    }
+
+    xt_thread_pool_group group;
+    thread_pool_group_init(&group, pool);
+
+    for (unsigned int i = 1; i < ways; i++)
+    {
+        if (0 != thread_pool_group_put(&group, thread_pool_loop_proc, loop))
+        {
+            break;      // 添加失败时由已有的线程执行全部的段
+        }
+    }
+
+    thread_pool_loop_proc(loop);
+
+    int ret = thread_pool_group_wait_all(&group);
+
+    if (0 != ret)
+    {
+        // 线程池停止时仍要等执行中的段完成、没有执行的任务被丢弃,之后loop和group才可释放
+        thread_pool_settle(pool, worker, &(group.count));
+    }
+
+    return ret;
+}
+
+/**
+ *\brief                并行循环,对[begin, end)分段调用proc,调用线程也参与执行,全部完成后返回
+ *\param[in]    pool    线程池
+ *\param[in]    begin   开始位置
+ *\param[in]    end     结束位置,不含
+ *\param[in]    grain   每段的最小长度,剩余多时分段长,剩余少时分段短,0为按线程数量自动计算
+ *\param[in]    proc    循环回调接口,不同段可能同时在不同线程中执行
+ *\param[in]    ctx     循环回调接口参数
+ *\return       0       成功\n
+ *              -2      线程池已停止,各段仍已由调用线程或线程池线程执行完
+ */
+int thread_pool_parallel_for(p_xt_thread_pool pool, size_t begin, size_t end, size_t grain, XT_THREAD_POOL_FOR_CALLBACK proc, void *ctx)
+{
+    if (NULL == pool || NULL == proc || begin > end)
+    {
+        return -1;
+    }
+
+    if (begin == end)
+    {
+        return 0;
+    }
+
+    xt_thread_pool_loop loop;
+    loop.proc   = proc;
+    loop.map    = NULL;
+    loop.ctx    = ctx;
+    loop.size   = 0;
+
+    return thread_pool_loop_run(pool, &loop, begin, end, grain, NULL);
+}
+
+/**
+ *\brief                并行归约,每个参与的线程把各段的结果合并到自己的value中,全部完成后再依次合并到value
+ *\param[in]    pool    线程池
+ *\param[in]    begin   开始位置
+ *\param[in]    end     结束位置,不含
+ *\param[in]    grain   每段的最小长度,0为按线程数量自动计算
+ *\param[in]    map     归约回调接口
+ *\param[in]    reduce  合并接口,合并顺序不固定,需满足结合律和交换律
+ *\param[in]    ctx     回调接口参数
+ *\param[in,out] value  初值为单位元(如求和时为0),各线程的value从此复制,返回时为结果
+ *\param[in]    size    value的大小
+ *\return       0       成功\n
+ *              -2      线程池已停止,各段仍已执行完,value为结果\n
+ *              -3      分配内存失败
+ */
+int thread_pool_parallel_reduce(p_xt_thread_pool pool, size_t begin, size_t end, size_t grain,
+                                XT_THREAD_POOL_MAP_CALLBACK map, XT_THREAD_POOL_REDUCE_CALLBACK reduce,
+                                void *ctx, void *value, size_t size)
+{
+    if (NULL == pool || NULL == map || NULL == reduce || NULL == value || 0 == size || begin > end)
+    {
+        return -1;
+    }
+
+    if (begin == end)
+    {
+        return 0;
+    }
+
+    xt_thread_pool_loop loop;
+    loop.proc   = NULL;
+    loop.map    = map;
+    loop.ctx    = ctx;
+    loop.size   = size;
+
+    int ret = thread_pool_loop_run(pool, &loop, begin, end, grain, value);
+
+    if (-3 == ret)
+    {
+        return ret;
+    }
+
+    // 返回0或-2时各线程都已不再访问loop.value
+    for (unsigned int i = 0; i < loop.ways; i++)
+    {
+        reduce(value, loop.value + size * i, ctx);
     }
 
-    p_xt_thread_pool_task task = (p_xt_thread_pool_task)malloc(sizeof(xt_thread_pool_task));
-    task->proc  = proc;
-    task->param = param;
-    return list_tail_push(&(pool->task_queue), task);
+    free(loop.value);
+    return ret;
 }
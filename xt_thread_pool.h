@@ -8,14 +8,65 @@
  */
 #ifndef _XT_THEAD_POOL_H
 #define _XT_THEAD_POOL_H
+#include <stddef.h>
 #include "xt_list.h"
+#include "xt_memory_pool.h"
 
 #ifndef bool
 #define bool unsigned char
 #endif
 
+#define THREAD_POOL_NAME_SIZE   11                      ///< 线程名称前缀最大长度,含结尾的0,加上序号超过15字节时截断
+
+/// 任务优先级
+enum
+{
+    THREAD_POOL_PRIORITY_HIGH,                          ///< 高,交互任务,优先执行
+    THREAD_POOL_PRIORITY_NORMAL,                        ///< 普通,thread_pool_put的优先级
+    THREAD_POOL_PRIORITY_LOW,                           ///< 后台,批量任务,没有其它任务时执行
+    THREAD_POOL_PRIORITY_COUNT                          ///< 优先级数量
+};
+
+/// 队列满时添加任务的处理方式
+enum
+{
+    THREAD_POOL_OVERFLOW_BLOCK,                         ///< 等待队列有空位,超时返回-2,线程池线程添加时直接执行,避免所有线程都在等待
+    THREAD_POOL_OVERFLOW_REJECT,                        ///< 不添加,返回-2
+    THREAD_POOL_OVERFLOW_DROP_OLDEST,                   ///< 丢弃最早的任务,先丢弃低优先级的,丢弃的任务不执行,所属任务组计为完成,任务结果为NULL
+    THREAD_POOL_OVERFLOW_CALLER_RUNS                    ///< 在添加任务的线程中直接执行,添加任务的线程变慢
+};
+
 typedef void (*XT_THREAD_POOL_TASK_CALLBACK)(void*);    ///< 线程池回调接口
 
+typedef void* (*XT_THREAD_POOL_FUTURE_CALLBACK)(void*); ///< 有返回值的线程池回调接口
+
+typedef void (*XT_THREAD_POOL_FOR_CALLBACK)(size_t begin, size_t end, void *ctx);   ///< 并行循环回调接口,处理[begin, end)
+
+typedef void (*XT_THREAD_POOL_MAP_CALLBACK)(size_t begin, size_t end, void *ctx, void *value);   ///< 并行归约回调接口,把[begin, end)的结果合并到value
+
+typedef void (*XT_THREAD_POOL_REDUCE_CALLBACK)(void *value, const void *part, void *ctx);       ///< 并行归约合并接口,把part合并到value
+
+typedef struct _xt_thread_pool_group                    ///  任务组,等待一组任务全部完成
+{
+    struct _xt_thread_pool         *pool;               ///< 线程池
+
+    volatile long                   count;              ///< 未完成的任务数量
+
+} xt_thread_pool_group, *p_xt_thread_pool_group;
+
+typedef struct _xt_thread_pool_future                   ///  任务结果,由thread_pool_submit添加的任务完成后得到
+{
+    struct _xt_thread_pool         *pool;               ///< 线程池
+
+    XT_THREAD_POOL_FUTURE_CALLBACK  proc;               ///< 任务回调
+
+    void*                           param;              ///< 任务回调参数
+
+    void*                           result;             ///< 任务回调返回值
+
+    volatile long                   pending;            ///< 任务是否未完成
+
+} xt_thread_pool_future, *p_xt_thread_pool_future;
 
 typedef struct _xt_thread_pool_task                     ///  程任务数据
 {
@@ -23,17 +74,141 @@ typedef struct _xt_thread_pool_task                     ///  程任务数据
 
     void*                           param;              ///< 任务回调参数
 
+    p_xt_thread_pool_group          group;              ///< 所属任务组,可以为NULL
+
 } xt_thread_pool_task, *p_xt_thread_pool_task;
 
+typedef struct _xt_thread_pool_attr                     ///  线程池属性
+{
+    unsigned int    thread_count;                       ///< 线程数量,也是最少线程数量,初始化时创建
+
+    unsigned int    thread_max;                         ///< 最多线程数量,大于thread_count时按任务量增减线程,0为与thread_count相同
+
+    unsigned int    keep_alive;                         ///< 多于最少线程数量时,空闲超过此时间(毫秒)的线程退出
+
+    unsigned int    spawn_depth;                        ///< 所有线程都忙且队列中任务数达到此值时增加线程
+
+    unsigned int    spawn_wait;                         ///< 所有线程都忙且队列超过此时间(毫秒)没有取出任务时增加线程,0为不按时间增加
+
+    unsigned int    spin_count;                         ///< 队列为空时休眠前自旋检查的最大次数,0为不自旋直接休眠
+
+    bool            steal;                              ///< 是否使用工作窃取,每个线程一个双端队列,空闲线程从其它线程窃取任务
+
+    unsigned int    deque_size;                         ///< 工作窃取时每个线程双端队列的容量,取整为2的幂,满时放入共享队列
+
+    unsigned int    aging;                              ///< 低优先级队列超过此时间(毫秒)没有执行时先执行一次,0为不提升
+
+    const char*     name;                               ///< 线程名称前缀,线程名称为"前缀-序号",便于性能分析工具区分,NULL为不设置
+
+    const unsigned int* cpu;                            ///< 绑定的CPU编号数组,多个线程池使用不相交的CPU时互不干扰,NULL为不绑定
+
+    unsigned int    cpu_count;                          ///< CPU编号数量
+
+    bool            cpu_each;                           ///< true时第i个线程只绑定cpu[i % cpu_count],false时所有线程都绑定全部CPU
+
+    unsigned int    capacity;                           ///< 队列中等待执行的任务数上限,使任务占用的内存有上限,0为不限制
+
+    int             overflow;                           ///< 队列满时添加任务的处理方式,THREAD_POOL_OVERFLOW_BLOCK等
+
+    int             block_timeout;                      ///< THREAD_POOL_OVERFLOW_BLOCK时等待的时间(毫秒),一次添加多个任务时为总的等待时间,-1一直等待
+
+} xt_thread_pool_attr, *p_xt_thread_pool_attr;
+
+typedef struct _xt_thread_pool_worker                   ///  工作线程数据
+{
+    struct _xt_thread_pool         *pool;               ///< 所属线程池
+
+    p_xt_thread_pool_task volatile *deque;              ///< 双端队列数组(Chase-Lev),不使用工作窃取时为NULL
+
+    unsigned long                   mask;               ///< 双端队列数组大小减1
+
+    unsigned int                    seed;               ///< 选择窃取目标的随机数种子
+
+    volatile long                   active;             ///< 是否有线程使用,线程退出后可被新线程使用
+
+    volatile unsigned long          bottom;             ///< 队列底部,只有本线程在此放入和取出
+
+    char                            pad0[CACHE_LINE_SIZE];  ///< 填充,使顶部独占缓存行
+
+    volatile unsigned long          top;                ///< 队列顶部,其它线程在此窃取
+
+    char                            pad1[CACHE_LINE_SIZE - sizeof(unsigned long)];  ///< 填充
+
+} xt_thread_pool_worker, *p_xt_thread_pool_worker;
+
 typedef struct _xt_thread_pool                          ///  程池数据
 {
     bool            run;                                ///< 线程是否运行
 
-    unsigned int    thread_count;                       ///< 线程数量
+    volatile long   thread_count;                       ///< 当前线程数量
+
+    unsigned int    thread_min;                         ///< 最少线程数量
+
+    unsigned int    thread_max;                         ///< 最多线程数量,也是工作线程数组大小
+
+    unsigned int    keep_alive;                         ///< 多余线程空闲退出的时间(毫秒)
+
+    unsigned int    spawn_depth;                        ///< 增加线程的队列任务数
+
+    unsigned int    spawn_wait;                         ///< 增加线程的队列等待时间(毫秒)
+
+    unsigned int    spin_count;                         ///< 休眠前自旋检查的最大次数
+
+    bool            steal;                              ///< 是否使用工作窃取
+
+    volatile long   process_count;                      ///< 正在执行任务的线程数量,含等待结果时帮助执行任务的线程
+
+    unsigned int    aging;                              ///< 低优先级队列提升的时间(毫秒)
+
+    char            name[THREAD_POOL_NAME_SIZE];        ///< 线程名称前缀,为空时不设置
+
+    unsigned int*   cpu;                                ///< 绑定的CPU编号数组,与工作线程数组一起分配,NULL为不绑定
+
+    unsigned int    cpu_count;                          ///< CPU编号数量
+
+    bool            cpu_each;                           ///< 是否每个线程只绑定一个CPU
+
+    unsigned int    capacity;                           ///< 队列中等待执行的任务数上限,0为不限制
+
+    int             overflow;                           ///< 队列满时添加任务的处理方式
+
+    int             block_timeout;                      ///< 队列满时等待的时间(毫秒)
+
+    volatile long   queued;                             ///< 已添加还没有取出的任务数量,不限制时不计数
+
+    xt_list         task_queue[THREAD_POOL_PRIORITY_COUNT]; ///< 各优先级的任务队列,工作窃取时为外部线程添加任务的共享队列
+
+    volatile unsigned long task_time[THREAD_POOL_PRIORITY_COUNT];   ///< 各优先级队列最后取出或由空变为非空的时间(毫秒)
+
+    xt_memory_pool  task_pool;                          ///< 任务内存池,带线程缓存,添加任务时不用malloc
 
-    unsigned int    process_count;                      ///< 当前处理任务线程数量
+    p_xt_thread_pool_worker worker;                     ///< 工作线程数组,大小为最多线程数量
 
-    xt_list         task_queue;                         ///< 任务队列
+    pthread_key_t   key;                                ///< 线程局部存储,保存当前线程的工作线程数据
+
+    volatile long   alive;                              ///< 运行中的线程数量,最后退出的线程释放工作线程数组
+
+    volatile long   idle;                               ///< 工作窃取时休眠等待任务的线程数量
+
+    volatile long   signal;                             ///< 工作窃取时的唤醒次数,休眠前后不同时不再等待
+
+    volatile long   done_waiter;                        ///< 等待任务结果或任务组的线程数量
+
+    volatile long   done_signal;                        ///< 任务结果或任务组中任务完成的次数
+
+    pthread_mutex_t done_mutex;                         ///< 等待任务结果或任务组的锁
+
+    pthread_cond_t  done_cond;                          ///< 等待任务结果或任务组的条件变量
+
+    volatile long   full_waiter;                        ///< 队列满时等待的线程数量
+
+    pthread_mutex_t full_mutex;                         ///< 队列满时等待的锁
+
+    pthread_cond_t  full_cond;                          ///< 队列满时等待的条件变量
+
+    pthread_mutex_t idle_mutex;                         ///< 工作窃取时休眠等待的锁
+
+    pthread_cond_t  idle_cond;                          ///< 工作窃取时休眠等待的条件变量
 
 } xt_thread_pool, *p_xt_thread_pool;
 
@@ -46,6 +221,22 @@ typedef struct _xt_thread_pool                          ///  程池数据
  */
 int thread_pool_init(p_xt_thread_pool pool, unsigned int count);
 
+/**
+ *\brief                线程池属性初始化为默认值,线程数量为CPU数量,不自旋,不使用工作窃取
+ *\param[in]    attr    线程池属性
+ *\return       0       成功
+ */
+int thread_pool_attr_init(p_xt_thread_pool_attr attr);
+
+/**
+ *\brief                按属性初始化线程池
+ *\param[in]    pool    线程池
+ *\attention    pool    需要转递到线线程中,不要释放此内存,否则会野指针
+ *\param[in]    attr    线程池属性
+ *\return       0       成功
+ */
+int thread_pool_init_ex(p_xt_thread_pool pool, p_xt_thread_pool_attr attr);
+
 /**
  *\brief                 线程池反初始化
  *\param[in]    pool    线程池
@@ -54,12 +245,132 @@ int thread_pool_init(p_xt_thread_pool pool, unsigned int count);
 int thread_pool_uninit(p_xt_thread_pool pool);
 
 /**
- *\brief                添加任务
+ *\brief                添加普通优先级的任务,工作窃取时线程池线程添加的任务放入本线程的双端队列
  *\param[in]    pool    线程池
  *\param[in]    proc    任务回调接口
  *\param[in]    param   任务回调接口参数
- *\return       0       成功
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
  */
 int thread_pool_put(p_xt_thread_pool pool, XT_THREAD_POOL_TASK_CALLBACK proc, void *param);
 
+/**
+ *\brief                添加多个普通优先级的任务,每批任务只加一次锁
+ *\param[in]    pool    线程池
+ *\param[in]    task    任务数组,只使用proc和param
+ *\param[in,out] count  输入任务数量,输出添加的数量
+ *\return       0       成功\n
+ *              -2      队列已满,count为已添加的数量\n
+ *              -3      得到任务内存失败
+ */
+int thread_pool_put_n(p_xt_thread_pool pool, p_xt_thread_pool_task task, int *count);
+
+/**
+ *\brief                按优先级添加任务
+ *\param[in]    pool    线程池
+ *\param[in]    priority 优先级,THREAD_POOL_PRIORITY_HIGH等
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_put_priority(p_xt_thread_pool pool, int priority, XT_THREAD_POOL_TASK_CALLBACK proc, void *param);
+
+/**
+ *\brief                添加有返回值的任务
+ *\param[in]    pool    线程池
+ *\param[out]   future  任务结果,任务完成前不要释放此内存
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_submit(p_xt_thread_pool pool, p_xt_thread_pool_future future, XT_THREAD_POOL_FUTURE_CALLBACK proc, void *param);
+
+/**
+ *\brief                得到任务结果,不等待
+ *\param[in]    future  任务结果
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      任务未完成
+ */
+int thread_pool_future_get(p_xt_thread_pool_future future, void **result);
+
+/**
+ *\brief                等待任务完成,等待时执行线程池中的其它任务
+ *\param[in]    future  任务结果
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      线程池已停止
+ */
+int thread_pool_future_wait(p_xt_thread_pool_future future, void **result);
+
+/**
+ *\brief                限时等待任务完成,等待时执行线程池中的其它任务,执行的任务耗时长时可能超时
+ *\param[in]    future  任务结果
+ *\param[in]    timeout 超时时间(毫秒),0不等待,-1一直等待
+ *\param[out]   result  任务回调返回值,可以为NULL
+ *\return       0       成功\n
+ *              -2      超时或线程池已停止
+ */
+int thread_pool_future_wait_for(p_xt_thread_pool_future future, int timeout, void **result);
+
+/**
+ *\brief                初始化任务组
+ *\param[in]    group   任务组
+ *\param[in]    pool    线程池
+ *\return       0       成功
+ */
+int thread_pool_group_init(p_xt_thread_pool_group group, p_xt_thread_pool pool);
+
+/**
+ *\brief                向任务组添加任务
+ *\param[in]    group   任务组
+ *\param[in]    proc    任务回调接口
+ *\param[in]    param   任务回调接口参数
+ *\return       0       成功\n
+ *              -2      队列已满,按THREAD_POOL_OVERFLOW_REJECT拒绝或等待超时
+ */
+int thread_pool_group_put(p_xt_thread_pool_group group, XT_THREAD_POOL_TASK_CALLBACK proc, void *param);
+
+/**
+ *\brief                等待任务组的任务全部完成,等待时执行线程池中的任务而不是阻塞
+ *\param[in]    group   任务组
+ *\return       0       成功\n
+ *              -2      线程池已停止
+ */
+int thread_pool_group_wait_all(p_xt_thread_pool_group group);
+
+/**
+ *\brief                并行循环,对[begin, end)分段调用proc,调用线程也参与执行,全部完成后返回
+ *\param[in]    pool    线程池
+ *\param[in]    begin   开始位置
+ *\param[in]    end     结束位置,不含
+ *\param[in]    grain   每段的最小长度,剩余多时分段长,剩余少时分段短,0为按线程数量自动计算
+ *\param[in]    proc    循环回调接口,不同段可能同时在不同线程中执行
+ *\param[in]    ctx     循环回调接口参数
+ *\return       0       成功\n
+ *              -2      线程池已停止,各段仍已由调用线程或线程池线程执行完
+ */
+int thread_pool_parallel_for(p_xt_thread_pool pool, size_t begin, size_t end, size_t grain, XT_THREAD_POOL_FOR_CALLBACK proc, void *ctx);
+
+/**
+ *\brief                并行归约,每个参与的线程把各段的结果合并到自己的value中,全部完成后再依次合并到value
+ *\param[in]    pool    线程池
+ *\param[in]    begin   开始位置
+ *\param[in]    end     结束位置,不含
+ *\param[in]    grain   每段的最小长度,0为按线程数量自动计算
+ *\param[in]    map     归约回调接口
+ *\param[in]    reduce  合并接口,合并顺序不固定,需满足结合律和交换律
+ *\param[in]    ctx     回调接口参数
+ *\param[in,out] value  初值为单位元(如求和时为0),各线程的value从此复制,返回时为结果
+ *\param[in]    size    value的大小
+ *\return       0       成功\n
+ *              -2      线程池已停止,各段仍已执行完,value为结果\n
+ *              -3      分配内存失败
+ */
+int thread_pool_parallel_reduce(p_xt_thread_pool pool, size_t begin, size_t end, size_t grain,
+                                XT_THREAD_POOL_MAP_CALLBACK map, XT_THREAD_POOL_REDUCE_CALLBACK reduce,
+                                void *ctx, void *value, size_t size);
+
 #endif
@@ -155,7 +155,7 @@ void* timer_thread(p_xt_timer_set set)
 
         //D(now);
 
-        list_proc(&(set->timer_list), timer_check, (void*)now);
+        list_proc_snapshot(&(set->timer_list), timer_check, (void*)now);   // 锁外检查,不阻塞添加定时器
     }
 
     D("exit");
@@ -64,6 +64,50 @@
     #define PATH_SEG        '/'                                                 ///< LINUX路径分割符
 #endif // _WINDOWS
 
+#ifndef CACHE_LINE_SIZE
+    #define CACHE_LINE_SIZE 64                                                  ///< CPU缓存行大小
+#endif
+
+// 按对齐分配内存,对齐值为2的幂
+#ifdef _WINDOWS
+    #define ALIGNED_MALLOC(p, align, size)  ((p) = _aligned_malloc(size, align))  ///< 分配对齐的内存
+    #define ALIGNED_FREE(p)                 _aligned_free(p)                    ///< 释放对齐的内存
+#else
+    #define ALIGNED_MALLOC(p, align, size)  (0 == posix_memalign((void**)&(p), align, size) ? (p) : ((p) = NULL))  ///< 分配对齐的内存
+    #define ALIGNED_FREE(p)                 free(p)                             ///< 释放对齐的内存
+#endif
+
+// 原子操作,操作数为long(WINDOWS下为32位)或指针,ATOMIC_LOAD64和ATOMIC_CAS64的操作数为64位整数
+#ifdef _WINDOWS
+    #define ATOMIC_LOAD(p)          (*(p))                                      ///< 读取,VC的volatile读带acquire语义
+    #define ATOMIC_STORE(p, v)      (*(p) = (v))                                ///< 写入,VC的volatile写带release语义
+    #define ATOMIC_ADD(p, v)        (InterlockedExchangeAdd((volatile long*)(p), (long)(v)) + (long)(v)) ///< 加,返回新值
+    #define ATOMIC_CAS(p, o, n)     (InterlockedCompareExchange((volatile long*)(p), (long)(n), (long)(o)) == (long)(o)) ///< 比较交换
+    #define ATOMIC_CAS_PTR(p, o, n) (InterlockedCompareExchangePointer((PVOID volatile*)(p), (PVOID)(n), (PVOID)(o)) == (PVOID)(o)) ///< 指针比较交换
+    #define ATOMIC_FENCE()          MemoryBarrier()                             ///< 全内存屏障
+    #ifdef _WIN64
+        #define ATOMIC_LOAD64(p)    (*(p))                                      ///< 64位读取
+    #else
+        #define ATOMIC_LOAD64(p)    ((unsigned __int64)InterlockedCompareExchange64((volatile LONGLONG*)(p), 0, 0)) ///< 64位读取,32位系统下用比较交换保证原子
+    #endif
+    #define ATOMIC_CAS64(p, o, n)   (InterlockedCompareExchange64((volatile LONGLONG*)(p), (LONGLONG)(n), (LONGLONG)(o)) == (LONGLONG)(o)) ///< 64位比较交换
+    #define CPU_RELAX()             YieldProcessor()                            ///< 自旋等待时让出流水线
+#else
+    #define ATOMIC_LOAD(p)          __atomic_load_n(p, __ATOMIC_ACQUIRE)        ///< 读取
+    #define ATOMIC_STORE(p, v)      __atomic_store_n(p, v, __ATOMIC_RELEASE)    ///< 写入
+    #define ATOMIC_ADD(p, v)        __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL)  ///< 加,返回新值
+    #define ATOMIC_CAS(p, o, n)     __sync_bool_compare_and_swap(p, o, n)       ///< 比较交换
+    #define ATOMIC_CAS_PTR(p, o, n) __sync_bool_compare_and_swap(p, o, n)       ///< 指针比较交换
+    #define ATOMIC_FENCE()          __atomic_thread_fence(__ATOMIC_SEQ_CST)     ///< 全内存屏障
+    #define ATOMIC_LOAD64(p)        __atomic_load_n(p, __ATOMIC_ACQUIRE)        ///< 64位读取
+    #define ATOMIC_CAS64(p, o, n)   __sync_bool_compare_and_swap(p, o, n)       ///< 64位比较交换
+    #if defined(__i386__) || defined(__x86_64__)
+        #define CPU_RELAX()         __builtin_ia32_pause()                      ///< 自旋等待时让出流水线
+    #else
+        #define CPU_RELAX()         __asm__ __volatile__("" ::: "memory")       ///< 自旋等待时让出流水线
+    #endif
+#endif
+
 
 /**
  *\brief                    得到格式化后的信息